@@ -0,0 +1,48 @@
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+#include "Fixed_Delimiter_Tokenizer.h"
+#include "Static_String_Calculator.h"
+#include "String_Calculator.h"
+#include "Tokenizer.h"
+
+static const std::string short_expression( "1,2,3\n4,5,600,7\n8" );
+
+static void BM_String_Calculator_Tokenizer( benchmark::State & state )
+{
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+
+	for( auto _ : state )
+	{
+		benchmark::DoNotOptimize( calculator.add(short_expression) );
+	}
+}
+BENCHMARK(BM_String_Calculator_Tokenizer);
+
+static void BM_Static_String_Calculator_Tokenizer( benchmark::State & state )
+{
+	Tokenizer tokenizer;
+	Static_String_Calculator<Tokenizer> calculator( tokenizer );
+
+	for( auto _ : state )
+	{
+		benchmark::DoNotOptimize( calculator.add(short_expression) );
+	}
+}
+BENCHMARK(BM_Static_String_Calculator_Tokenizer);
+
+static void BM_Static_String_Calculator_Fixed_Delimiter_Tokenizer( benchmark::State & state )
+{
+	typedef Fixed_Delimiter_Tokenizer<',', '\n'> Default_Tokenizer;
+
+	Default_Tokenizer tokenizer;
+	Static_String_Calculator<Default_Tokenizer> calculator( tokenizer );
+
+	for( auto _ : state )
+	{
+		benchmark::DoNotOptimize( calculator.add(short_expression) );
+	}
+}
+BENCHMARK(BM_Static_String_Calculator_Fixed_Delimiter_Tokenizer);
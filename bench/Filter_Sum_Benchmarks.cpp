@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "Filter_Sum_Kernel.h"
+
+static const size_t number_count = 1 << 16;
+
+// Half the numbers are over one thousand, so when they are in random order
+// a branch on each one is mispredicted about half the time.
+static std::vector<int> make_numbers( bool sorted )
+{
+	std::mt19937 generator( 1 );
+	std::uniform_int_distribution<int> number( 0, 2000 );
+
+	std::vector<int> numbers( number_count );
+	for( int & n : numbers )
+	{
+		n = number( generator );
+	}
+
+	if( sorted )
+	{
+		std::sort( numbers.begin(), numbers.end() );
+	}
+
+	return numbers;
+}
+
+// The rules as Sum_Accumulator applied them before Filter_Sum_Kernel, one
+// branch per number.  The barrier stops the compiler from turning the
+// branch into a conditional move.
+static void BM_Branchy_Filter_Sum( benchmark::State & state )
+{
+	const std::vector<int> numbers = make_numbers( state.range(0) != 0 );
+
+	for( auto _ : state )
+	{
+		int total = 0;
+		bool has_negative_numbers = false;
+
+		for( int number : numbers )
+		{
+			if( number < 0 )
+			{
+				has_negative_numbers = true;
+			}
+			else if( number <= 1000 )
+			{
+				total += number;
+				benchmark::ClobberMemory();
+			}
+		}
+
+		benchmark::DoNotOptimize( total );
+		benchmark::DoNotOptimize( has_negative_numbers );
+	}
+
+	state.SetItemsProcessed( static_cast<int64_t>(state.iterations() * numbers.size()) );
+}
+BENCHMARK(BM_Branchy_Filter_Sum)->ArgName("sorted")->Arg(0)->Arg(1);
+
+static void BM_Filter_Sum_Kernel( benchmark::State & state )
+{
+	const std::vector<int> numbers = make_numbers( state.range(0) != 0 );
+	const Filter_Sum_Kernel kernel( static_cast<Filter_Sum_Kernel::Kernel>(state.range(1)) );
+
+	for( auto _ : state )
+	{
+		benchmark::DoNotOptimize( kernel.filter_sum(numbers.data(), numbers.size(), 1000) );
+	}
+
+	state.SetItemsProcessed( static_cast<int64_t>(state.iterations() * numbers.size()) );
+}
+BENCHMARK(BM_Filter_Sum_Kernel)->ArgNames({"sorted", "kernel"})->ArgsProduct({{0, 1}, {static_cast<int>(Filter_Sum_Kernel::Kernel::scalar), static_cast<int>(Filter_Sum_Kernel::Kernel::sse2), static_cast<int>(Filter_Sum_Kernel::Kernel::avx2)}});
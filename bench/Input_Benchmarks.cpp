@@ -0,0 +1,243 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "Add_Result_Cache.h"
+#include "Add_Session.h"
+#include "String_Calculator.h"
+#include "Tokenizer.h"
+
+// count numbers from number(i), separated by the delimiters in turn.
+template<typename Number_Function>
+static std::string make_expression( const std::string & header, const std::vector<std::string> & delimiters, size_t count, Number_Function number )
+{
+	std::string expression( header );
+
+	for( size_t i = 0; i < count; ++i )
+	{
+		if( i > 0 )
+		{
+			expression += delimiters[i % delimiters.size()];
+		}
+		expression += std::to_string( number(i) );
+	}
+
+	return expression;
+}
+
+static int small_number( size_t i )
+{
+	return static_cast<int>( i % 1000 );
+}
+
+static void run_add( benchmark::State & state, const std::string & expression )
+{
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+
+	for( auto _ : state )
+	{
+		benchmark::DoNotOptimize( calculator.add(expression) );
+	}
+
+	state.SetBytesProcessed( static_cast<int64_t>(state.iterations() * expression.size()) );
+}
+
+static void BM_Tiny_Expressions( benchmark::State & state )
+{
+	const std::vector<std::string> expressions = { "", "1", "1,2", "1\n2,3", "//;\n1;2", "1001,2" };
+
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+
+	for( auto _ : state )
+	{
+		for( const std::string & expression : expressions )
+		{
+			benchmark::DoNotOptimize( calculator.add(expression) );
+		}
+	}
+
+	state.SetItemsProcessed( static_cast<int64_t>(state.iterations() * expressions.size()) );
+}
+BENCHMARK(BM_Tiny_Expressions);
+
+// 1024 short expressions, every eighth of them with a negative if
+// state.range(0) is set.  add_batch() only pulls ahead of a loop over
+// add() when items fail, since it reports them without throwing.
+static std::vector<std::string> make_batch( const benchmark::State & state )
+{
+	std::vector<std::string> expressions;
+
+	for( size_t i = 0; i < 1024; ++i )
+	{
+		const bool has_negative = (state.range(0) != 0) && (i % 8 == 0);
+		expressions.push_back( make_expression("", { ",", "\n" }, 4, [i, has_negative]( size_t j ){ return (has_negative && (j == 1)) ? -1 : small_number(i + j); }) );
+	}
+
+	return expressions;
+}
+
+static void BM_Add_Loop( benchmark::State & state )
+{
+	const std::vector<std::string> expressions = make_batch( state );
+
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+
+	for( auto _ : state )
+	{
+		for( const std::string & expression : expressions )
+		{
+			try
+			{
+				benchmark::DoNotOptimize( calculator.add(expression) );
+			}
+			catch( const std::invalid_argument & e )
+			{
+				benchmark::DoNotOptimize( e.what() );
+			}
+		}
+	}
+
+	state.SetItemsProcessed( static_cast<int64_t>(state.iterations() * expressions.size()) );
+}
+BENCHMARK(BM_Add_Loop)->ArgName("negatives")->Arg(0)->Arg(1);
+
+static void BM_Add_Batch( benchmark::State & state )
+{
+	const std::vector<std::string> expressions = make_batch( state );
+	std::vector<int> results( expressions.size() );
+	std::vector<std::string> error_messages( expressions.size() );
+
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+
+	for( auto _ : state )
+	{
+		calculator.add_batch( expressions.data(), expressions.size(), results.data(), error_messages.data() );
+		benchmark::DoNotOptimize( results.data() );
+	}
+
+	state.SetItemsProcessed( static_cast<int64_t>(state.iterations() * expressions.size()) );
+}
+BENCHMARK(BM_Add_Batch)->ArgName("negatives")->Arg(0)->Arg(1);
+
+static void BM_Giant_Default_Expression( benchmark::State & state )
+{
+	run_add( state, make_expression("", { ",", "\n" }, state.range(0), small_number) );
+}
+BENCHMARK(BM_Giant_Default_Expression)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+static void BM_Many_Single_Char_Delimiters( benchmark::State & state )
+{
+	const std::string characters( ";:|!#$&*+=?@^_~%" );
+	std::vector<std::string> delimiters;
+	std::string header( "//" );
+
+	for( char c : characters.substr(0, state.range(0)) )
+	{
+		delimiters.emplace_back( 1, c );
+		header += "[" + delimiters.back() + "]";
+	}
+	header += "\n";
+
+	run_add( state, make_expression(header, delimiters, 1 << 16, small_number) );
+}
+BENCHMARK(BM_Many_Single_Char_Delimiters)->Arg(1)->Arg(4)->Arg(16);
+
+static void BM_Long_Multi_Char_Delimiters( benchmark::State & state )
+{
+	const std::vector<std::string> delimiters = { std::string(state.range(0), '*'), std::string(state.range(0), '%') };
+	const std::string header( "//[" + delimiters[0] + "][" + delimiters[1] + "]\n" );
+
+	run_add( state, make_expression(header, delimiters, 1 << 16, small_number) );
+}
+BENCHMARK(BM_Long_Multi_Char_Delimiters)->Arg(2)->Arg(8)->Arg(32);
+
+// Every other number is negative, so every call ends in an exception that
+// lists half of the numbers.
+static void BM_Negative_Heavy( benchmark::State & state )
+{
+	const std::string expression( make_expression("", { "," }, state.range(0), []( size_t i ){ return (i % 2 == 0) ? -small_number(i) - 1 : small_number(i); }) );
+
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+
+	for( auto _ : state )
+	{
+		try
+		{
+			benchmark::DoNotOptimize( calculator.add(expression) );
+		}
+		catch( const std::invalid_argument & e )
+		{
+			benchmark::DoNotOptimize( e.what() );
+		}
+	}
+
+	state.SetBytesProcessed( static_cast<int64_t>(state.iterations() * expression.size()) );
+}
+BENCHMARK(BM_Negative_Heavy)->Arg(16)->Arg(1 << 16);
+
+static void BM_Negative_Heavy_Try_Add( benchmark::State & state )
+{
+	const std::string expression( make_expression("", { "," }, state.range(0), []( size_t i ){ return (i % 2 == 0) ? -small_number(i) - 1 : small_number(i); }) );
+
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+
+	for( auto _ : state )
+	{
+		benchmark::DoNotOptimize( calculator.try_add(expression).has_value() );
+	}
+
+	state.SetBytesProcessed( static_cast<int64_t>(state.iterations() * expression.size()) );
+}
+BENCHMARK(BM_Negative_Heavy_Try_Add)->Arg(16)->Arg(1 << 16);
+
+static void BM_Over_One_Thousand_Heavy( benchmark::State & state )
+{
+	run_add( state, make_expression("", { "," }, 1 << 16, []( size_t i ){ return (i % 10 == 0) ? small_number(i) : 1001 + static_cast<int>(i % 100000); }) );
+}
+BENCHMARK(BM_Over_One_Thousand_Heavy);
+
+// Each iteration appends one "nnn," fragment to an ever longer expression.
+static void BM_Add_Session_Append( benchmark::State & state )
+{
+	Tokenizer tokenizer;
+	Add_Session session( tokenizer );
+	size_t i = 0;
+
+	for( auto _ : state )
+	{
+		benchmark::DoNotOptimize( session.append(std::to_string(small_number(i++)) + ",") );
+	}
+}
+BENCHMARK(BM_Add_Session_Append);
+
+static void BM_Repeated_Expressions_With_Result_Cache( benchmark::State & state )
+{
+	std::vector<std::string> expressions;
+	for( size_t i = 0; i < 64; ++i )
+	{
+		expressions.push_back( make_expression("", { ",", "\n" }, 256, [i]( size_t j ){ return small_number(i + j); }) );
+	}
+
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+	Add_Result_Cache cache( 1024 );
+	if( state.range(0) != 0 )
+	{
+		calculator.set_result_cache( &cache );
+	}
+
+	size_t i = 0;
+	for( auto _ : state )
+	{
+		benchmark::DoNotOptimize( calculator.add(expressions[i++ % expressions.size()]) );
+	}
+}
+BENCHMARK(BM_Repeated_Expressions_With_Result_Cache)->Arg(0)->Arg(1);
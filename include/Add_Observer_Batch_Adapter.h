@@ -0,0 +1,22 @@
+#ifndef ADD_OBSERVER_BATCH_ADAPTER_H
+#define ADD_OBSERVER_BATCH_ADAPTER_H
+
+#include "Add_Observer_Interface.h"
+#include "Batched_Add_Observer_Interface.h"
+
+// Hands each event of a batch to an existing Add_Observer_Interface in turn.
+class Add_Observer_Batch_Adapter : public Batched_Add_Observer_Interface
+{
+	public:
+
+		Add_Observer_Batch_Adapter( Add_Observer_Interface & observer );
+
+		void add_occurred_batch( const Add_Event * events, size_t count ) override;
+		bool needs_expression() const override;
+
+	private:
+
+		Add_Observer_Interface & m_observer;
+};
+
+#endif /*ADD_OBSERVER_BATCH_ADAPTER_H*/
@@ -9,6 +9,13 @@ class Add_Observer_Interface
 		virtual ~Add_Observer_Interface() {}
 
 		virtual void add_occurred( const std::string & expression, int result ) = 0;
+
+		// Observers that only look at the result can return false so that
+		// adapters which queue events need not copy the expression.
+		virtual bool needs_expression() const
+		{
+			return true;
+		}
 };
 
 #endif /*ADD_OBSERVER_INTERFACE_H*/
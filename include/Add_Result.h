@@ -0,0 +1,75 @@
+#ifndef ADD_RESULT_H
+#define ADD_RESULT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// A negative number found by String_Calculator::try_add(), and the offset
+// of its token in the expression, or npos where the tokenizer did not hand
+// out views into the expression.
+struct Negative_Number
+{
+	static const size_t npos = static_cast<size_t>( -1 );
+
+	int value;
+	size_t position;
+};
+
+// Why try_add() had no result: the expression held negative numbers, a
+// token that is not a number or does not fit in an int, or, with overflow
+// checking on, a total that does not fit in an int.
+class Add_Error
+{
+	public:
+
+		enum class Kind { negative_numbers, invalid_number, number_out_of_range, total_out_of_range };
+
+		// negative_numbers holds at most the reported number of negatives,
+		// out of negative_number_count in all.
+		Add_Error( std::vector<Negative_Number> negative_numbers, size_t negative_number_count );
+		Add_Error( Kind kind, std::string description );
+
+		Kind kind() const;
+		const std::vector<Negative_Number> & negative_numbers() const;
+		size_t negative_number_count() const;
+
+		// The message add() would have thrown with, built on demand.  Only
+		// the reported negatives are listed, followed by "..." if there
+		// were more.
+		std::string message() const;
+
+	private:
+
+		Kind m_kind;
+		std::vector<Negative_Number> m_negative_numbers;
+		size_t m_negative_number_count;
+		std::string m_description;
+};
+
+// The outcome of String_Calculator::try_add(): either the sum or an
+// Add_Error, in the manner of std::expected.
+class Add_Result
+{
+	public:
+
+		Add_Result( int value );
+		Add_Result( Add_Error error );
+
+		bool has_value() const;
+		explicit operator bool() const;
+
+		// Throws std::logic_error if there is no value.
+		int value() const;
+
+		// Throws std::logic_error if there is a value.
+		const Add_Error & error() const;
+
+	private:
+
+		int m_value;
+		bool m_has_value;
+		Add_Error m_error;
+};
+
+#endif /*ADD_RESULT_H*/
@@ -0,0 +1,77 @@
+#ifndef ADD_RESULT_CACHE_H
+#define ADD_RESULT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Add_Result_Cache_Interface.h"
+
+// Remembers what add() made of recently seen expressions.  Expressions are hashed
+// to one of many shards, each with its own lock and a fixed number of
+// slots, so threads adding different expressions rarely contend.  A slot
+// matches on the hash, then the length, then the bytes.  When a shard is
+// full the CLOCK algorithm picks the slot to reuse: slots hit since the
+// hand last passed get a second chance.  Expressions longer than
+// max_expression_size are not cached, which bounds the memory a slot can
+// hold on to.  Safe to share between threads.
+class Add_Result_Cache : public Add_Result_Cache_Interface
+{
+	public:
+
+		// Room for at least capacity expressions, in shards of
+		// slots_per_shard.
+		explicit Add_Result_Cache( size_t capacity, size_t slots_per_shard = default_slots_per_shard, size_t max_expression_size = default_max_expression_size );
+
+		Add_Result_Cache( const Add_Result_Cache & ) = delete;
+		Add_Result_Cache & operator=( const Add_Result_Cache & ) = delete;
+
+		bool find( std::string_view expression, Entry & entry ) override;
+		void store_total( std::string_view expression, int64_t total ) override;
+		void store_negative_numbers( std::string_view expression, const std::string & message ) override;
+		size_t max_expression_size() const override;
+
+		size_t hit_count() const;
+		size_t miss_count() const;
+		double hit_rate() const;
+		size_t capacity() const;
+
+		static const size_t default_slots_per_shard = 8;
+		static const size_t default_max_expression_size = 4 * 1024;
+
+	private:
+
+		struct Slot
+		{
+			bool occupied;
+			bool referenced;
+			uint64_t hash;
+			std::string expression;
+			Entry entry;
+		};
+
+		struct Shard
+		{
+			std::mutex mutex;
+			std::vector<Slot> slots;
+			size_t clock_hand;
+			size_t hit_count;
+			size_t miss_count;
+		};
+
+		void store( std::string_view expression, bool has_negative_numbers, int64_t total, const std::string & message );
+		Shard & shard_for( uint64_t hash );
+		static Slot * find_slot( Shard & shard, uint64_t hash, std::string_view expression );
+		static Slot & victim( Shard & shard );
+
+		const size_t m_slots_per_shard;
+		const size_t m_max_expression_size;
+		size_t m_shard_count;
+		std::unique_ptr<Shard[]> mp_shards;
+};
+
+#endif /*ADD_RESULT_CACHE_H*/
@@ -0,0 +1,37 @@
+#ifndef ADD_RESULT_CACHE_INTERFACE_H
+#define ADD_RESULT_CACHE_INTERFACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Somewhere String_Calculator::add() can remember what it made of an
+// expression: either the total or the message of the negatives error it
+// threw.  The total is kept whole, even if it does not fit in an int, so
+// that a calculator checking for overflow can still tell.
+class Add_Result_Cache_Interface
+{
+	public:
+
+		struct Entry
+		{
+			bool has_negative_numbers;
+			int64_t total;
+			std::string negative_numbers_message;
+		};
+
+		virtual ~Add_Result_Cache_Interface() {}
+
+		// Copies the entry for expression, if there is one, into entry.
+		virtual bool find( std::string_view expression, Entry & entry ) = 0;
+
+		virtual void store_total( std::string_view expression, int64_t total ) = 0;
+		virtual void store_negative_numbers( std::string_view expression, const std::string & message ) = 0;
+
+		// Longer expressions are never cached; add() does not even look
+		// them up, which would cost a pass over the whole expression.
+		virtual size_t max_expression_size() const = 0;
+};
+
+#endif /*ADD_RESULT_CACHE_INTERFACE_H*/
@@ -0,0 +1,58 @@
+#ifndef ADD_SESSION_H
+#define ADD_SESSION_H
+
+#include <exception>
+#include <string>
+#include <string_view>
+
+#include "Expression_Format.h"
+#include "Sum_Accumulator.h"
+
+class Tokenizer;
+
+// An expression that arrives a fragment at a time, totalled again after
+// each one without going back over what came before.  Once the header is
+// known, everything up to the last cut that more input can no longer move
+// is summed for good; only the short tail after it, which may still be an
+// unfinished token or delimiter, is looked at again on the next append.
+// There are two exceptions, where the whole expression is re-read on every
+// append, so that a long one arriving in small fragments costs O(n^2):
+// an unterminated "//[" header, until its "]\n" arrives, and delimiters
+// that Delimiter_Matcher::is_single_pass() turns down, such as two whose
+// matches can overlap or one holding a comma, for which no cut is ever
+// safe.
+class Add_Session
+{
+	public:
+
+		explicit Add_Session( const Tokenizer & tokenizer );
+
+		Add_Session( const Add_Session & ) = delete;
+		Add_Session & operator=( const Add_Session & ) = delete;
+
+		// Appends fragment to the expression and returns what
+		// String_Calculator::add() would for the whole of it so far, throwing
+		// what add() would throw.  A bad token that can no longer change
+		// makes every later append throw too.
+		int append( std::string_view fragment );
+
+		// As String_Calculator::set_overflow_checking(): append() throws
+		// std::overflow_error when the total so far does not fit in an int,
+		// where otherwise it would return it wrapped around.  Off by default.
+		void set_overflow_checking( bool enabled );
+
+	private:
+
+		int total_with_pending() const;
+		int checked_total( const Sum_Accumulator & accumulator ) const;
+
+		const Tokenizer & m_tokenizer;
+		std::string m_pending;
+		bool m_has_format;
+		Expression_Format m_format;
+		Sum_Accumulator m_committed;
+		std::exception_ptr mp_committed_error;
+		bool m_checks_overflow;
+};
+
+#endif /*ADD_SESSION_H*/
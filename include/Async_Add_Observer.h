@@ -0,0 +1,103 @@
+#ifndef ASYNC_ADD_OBSERVER_H
+#define ASYNC_ADD_OBSERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Add_Observer_Interface.h"
+
+// Passes add_occurred() events on to another observer from a background
+// thread, so a slow observer no longer holds up add().  Events go through a
+// bounded lock-free ring buffer that any number of threads may push to.
+// What happens when it is full is up to the overflow policy:
+//
+//   drop   - the event is discarded and counted.
+//   block  - the caller waits for room.
+//   sample - every sample_every-th overflowing event waits for room and
+//            the rest are discarded and counted.
+//
+// Waiting callers, and the background thread while the buffer is empty,
+// sleep on a condition variable rather than spinning; a push only takes a
+// lock to wake the background thread when it finds the buffer empty.
+// Each slot reserves room for an expression of reserved_expression_size
+// bytes up front, so a push only allocates the first time a longer
+// expression lands in its slot.  If the observer's needs_expression() is
+// false the expression is not copied at all and the observer is handed an
+// empty one.  An exception the
+// observer throws has nowhere to go on the background thread, so it is
+// counted and dropped, and delivery carries on with the next event.
+class Async_Add_Observer : public Add_Observer_Interface
+{
+	public:
+
+		enum class Overflow_Policy { drop, block, sample };
+
+		Async_Add_Observer( Add_Observer_Interface & observer, size_t capacity, Overflow_Policy policy = Overflow_Policy::drop, size_t sample_every = 16 );
+		~Async_Add_Observer();
+
+		Async_Add_Observer( const Async_Add_Observer & ) = delete;
+		Async_Add_Observer & operator=( const Async_Add_Observer & ) = delete;
+
+		void add_occurred( const std::string & expression, int result ) override;
+
+		// Waits until every event accepted so far has been delivered.
+		void flush();
+
+		size_t capacity() const;
+		size_t delivered_count() const;
+		size_t dropped_count() const;
+
+		// Events whose delivery threw.  They are included in
+		// delivered_count().
+		size_t failed_count() const;
+
+		static const size_t reserved_expression_size = 128;
+
+	private:
+
+		struct Slot
+		{
+			std::atomic<size_t> sequence;
+			std::string expression;
+			int result;
+		};
+
+		bool try_push( const std::string & expression, int result );
+		bool try_pop_and_deliver();
+		bool has_event_to_deliver() const;
+		void drain_loop();
+
+		template<typename Predicate>
+		void wait_for_delivery( Predicate is_done );
+
+		Add_Observer_Interface & m_observer;
+		const bool m_copy_expressions;
+		const Overflow_Policy m_policy;
+		const size_t m_sample_every;
+		const size_t m_capacity;
+		const std::unique_ptr<Slot[]> mp_slots;
+
+		alignas(64) std::atomic<size_t> m_push_pos;
+		alignas(64) size_t m_pop_pos;
+		alignas(64) std::atomic<size_t> m_delivered_count;
+		std::atomic<size_t> m_dropped_count;
+		std::atomic<size_t> m_failed_count;
+		std::atomic<size_t> m_overflow_count;
+		std::atomic<bool> m_stopping;
+
+		std::mutex m_drain_mutex;
+		std::condition_variable m_event_pushed;
+
+		std::atomic<size_t> m_waiter_count;
+		std::mutex m_waiter_mutex;
+		std::condition_variable m_event_delivered;
+
+		std::thread m_drain_thread;
+};
+
+#endif /*ASYNC_ADD_OBSERVER_H*/
@@ -0,0 +1,31 @@
+#ifndef BATCHED_ADD_OBSERVER_INTERFACE_H
+#define BATCHED_ADD_OBSERVER_INTERFACE_H
+
+#include <cstddef>
+#include <string>
+
+struct Add_Event
+{
+	std::string expression;
+	int result;
+};
+
+// Like Add_Observer_Interface, but told about many adds in one call.
+// Coalescing_Add_Observer gathers the events; Add_Observer_Batch_Adapter
+// lets an ordinary Add_Observer_Interface receive them.
+class Batched_Add_Observer_Interface
+{
+	public:
+		virtual ~Batched_Add_Observer_Interface() {}
+
+		// The events are in the order the adds happened and are only valid
+		// for the duration of the call.
+		virtual void add_occurred_batch( const Add_Event * events, size_t count ) = 0;
+
+		virtual bool needs_expression() const
+		{
+			return true;
+		}
+};
+
+#endif /*BATCHED_ADD_OBSERVER_INTERFACE_H*/
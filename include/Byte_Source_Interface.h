@@ -0,0 +1,16 @@
+#ifndef BYTE_SOURCE_INTERFACE_H
+#define BYTE_SOURCE_INTERFACE_H
+
+#include <cstddef>
+
+class Byte_Source_Interface
+{
+	public:
+		virtual ~Byte_Source_Interface() {}
+
+		// Reads up to size bytes into buffer and returns how many were read.
+		// Returns zero once the source is exhausted.
+		virtual size_t read( char * buffer, size_t size ) = 0;
+};
+
+#endif /*BYTE_SOURCE_INTERFACE_H*/
@@ -0,0 +1,21 @@
+#ifndef CHUNKED_EXPRESSION_INTERFACE_H
+#define CHUNKED_EXPRESSION_INTERFACE_H
+
+#include <cstddef>
+
+#include "Token_Visitor_Interface.h"
+
+// An expression whose delimiters have already been worked out, cut into
+// consecutive chunks.  Visiting every chunk's tokens in chunk order gives
+// the same tokens as visiting the whole expression, and different chunks
+// may be visited from different threads at the same time.
+class Chunked_Expression_Interface
+{
+	public:
+		virtual ~Chunked_Expression_Interface() {}
+
+		virtual size_t chunk_count() const = 0;
+		virtual void visit_chunk_tokens( size_t chunk, Token_Visitor_Interface & visitor ) const = 0;
+};
+
+#endif /*CHUNKED_EXPRESSION_INTERFACE_H*/
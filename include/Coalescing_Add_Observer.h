@@ -0,0 +1,70 @@
+#ifndef COALESCING_ADD_OBSERVER_H
+#define COALESCING_ADD_OBSERVER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Add_Observer_Interface.h"
+#include "Batched_Add_Observer_Interface.h"
+
+// Collects add_occurred() events and hands them to a batched observer in
+// one call once batch_size have built up, or once the oldest has waited
+// max_delay, whichever comes first.  A zero max_delay turns the timer off,
+// leaving only full batches, flush() and destruction to deliver.  Batches
+// are delivered in order, from whichever thread fills a batch or from the
+// adapter's timer thread.  An exception the observer throws would have
+// nowhere to go on the timer thread or in the destructor, so wherever the
+// batch was delivered from it is counted and dropped.  Safe to share
+// between threads.
+class Coalescing_Add_Observer : public Add_Observer_Interface
+{
+	public:
+
+		Coalescing_Add_Observer( Batched_Add_Observer_Interface & observer, size_t batch_size, std::chrono::microseconds max_delay );
+		~Coalescing_Add_Observer();
+
+		Coalescing_Add_Observer( const Coalescing_Add_Observer & ) = delete;
+		Coalescing_Add_Observer & operator=( const Coalescing_Add_Observer & ) = delete;
+
+		void add_occurred( const std::string & expression, int result ) override;
+		bool needs_expression() const override;
+
+		// Delivers whatever is waiting now.
+		void flush();
+
+		size_t batch_count() const;
+
+		// Batches whose delivery threw.  They are included in
+		// batch_count().
+		size_t failed_count() const;
+
+	private:
+
+		void deliver_pending();
+		void timer_loop();
+
+		Batched_Add_Observer_Interface & m_observer;
+		const bool m_copy_expressions;
+		const size_t m_batch_size;
+		const std::chrono::microseconds m_max_delay;
+
+		std::mutex m_delivery_mutex;
+		mutable std::mutex m_mutex;
+		std::condition_variable m_first_event_added;
+		std::vector<Add_Event> m_pending;
+		size_t m_pending_count;
+		std::chrono::steady_clock::time_point m_oldest_pending_time;
+		std::vector<Add_Event> m_delivering;
+		size_t m_batch_count;
+		size_t m_failed_count;
+		bool m_stopping;
+
+		std::thread m_timer_thread;
+};
+
+#endif /*COALESCING_ADD_OBSERVER_H*/
@@ -0,0 +1,70 @@
+#ifndef DEFAULT_DELIMITER_SCANNER_H
+#define DEFAULT_DELIMITER_SCANNER_H
+
+#include <cstdint>
+#include <string_view>
+
+#include "Token_Visitor_Interface.h"
+
+// Splits text on the default "," and "\n" delimiters 64 bytes at a time.
+// Each block is classified into delimiter, minus sign and other non-digit
+// bitmasks with the widest vector unit the CPU offers, and plain decimal
+// tokens of up to eight digits are converted with SWAR arithmetic and
+// handed over in runs through numbers_found().  Anything unusual is passed
+// to token_found() untouched, after the numbers before it.
+class Default_Delimiter_Scanner
+{
+	public:
+
+		enum class Kernel { scalar, sse2, avx2, best_available };
+
+		Default_Delimiter_Scanner( Kernel kernel = Kernel::best_available );
+
+		void split( std::string_view text, Token_Visitor_Interface & visitor ) const;
+
+		Kernel kernel() const;
+
+		static bool is_supported( Kernel kernel );
+
+	private:
+
+		struct Block_Masks
+		{
+			uint64_t delimiters;
+			uint64_t minus_signs;
+			uint64_t others;
+		};
+
+		typedef Block_Masks (*Block_Classifier)( const char * block );
+
+		static constexpr size_t block_size = 64;
+		static constexpr size_t batch_capacity = 64;
+
+		// Lives on the stack for one split(), so the token views are kept in
+		// a union to save constructing all of them up front for the one or
+		// two numbers of a short expression.
+		struct Number_Batch
+		{
+			Number_Batch() : count( 0 ) {}
+
+			union { std::string_view tokens[batch_capacity]; };
+			int numbers[batch_capacity];
+			size_t count;
+		};
+
+		static Block_Masks classify_scalar( const char * block, size_t size );
+		static Block_Masks classify_scalar_block( const char * block );
+		static Block_Masks classify_sse2_block( const char * block );
+		static Block_Masks classify_avx2_block( const char * block );
+		static Block_Classifier classifier_for( Kernel kernel );
+
+		void emit_token( std::string_view token, bool is_plain_number, Number_Batch & batch, Token_Visitor_Interface & visitor ) const;
+		static void flush_numbers( Number_Batch & batch, Token_Visitor_Interface & visitor );
+		int parse_digits( const char * digits, size_t count ) const;
+
+		Kernel m_kernel;
+		Block_Classifier m_classify_block;
+};
+
+#endif /*DEFAULT_DELIMITER_SCANNER_H*/
+
@@ -0,0 +1,60 @@
+#ifndef DELIMITER_HEADER_CACHE_H
+#define DELIMITER_HEADER_CACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "Delimiter_Matcher.h"
+
+// Remembers what recently seen delimiter headers such as "//[***][%%]\n"
+// compile to, keyed on the header's raw bytes, so that a repeated header
+// costs one hash lookup instead of being parsed and compiled again.  At
+// most capacity headers are kept; the least recently used one is dropped
+// to make room.  Safe to share between threads.
+class Delimiter_Header_Cache
+{
+	public:
+
+		struct Compiled_Header
+		{
+			Delimiter_Matcher matcher;
+			bool is_default_format;
+		};
+
+		typedef std::function<std::shared_ptr<const Compiled_Header>( std::string_view header )> Compiler;
+
+		explicit Delimiter_Header_Cache( size_t capacity );
+
+		// The cached compilation of header, calling compile on a miss.
+		std::shared_ptr<const Compiled_Header> find_or_compile( std::string_view header, const Compiler & compile );
+
+		size_t hit_count() const;
+		size_t miss_count() const;
+		size_t size() const;
+		size_t capacity() const;
+
+	private:
+
+		struct Entry
+		{
+			std::string header;
+			std::shared_ptr<const Compiled_Header> compiled;
+		};
+
+		typedef std::list<Entry> Entry_List;
+
+		const size_t m_capacity;
+		mutable std::mutex m_mutex;
+		Entry_List m_entries;
+		std::unordered_map<std::string_view, Entry_List::iterator> m_index;
+		size_t m_hit_count;
+		size_t m_miss_count;
+};
+
+#endif /*DELIMITER_HEADER_CACHE_H*/
@@ -0,0 +1,85 @@
+#ifndef DELIMITER_MATCHER_H
+#define DELIMITER_MATCHER_H
+
+#include <array>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Token_Visitor_Interface.h"
+
+// A set of delimiters compiled into a byte trie.  At every position the
+// longest delimiter that starts there wins, so tokens are found in a single
+// left-to-right pass over the text however many delimiters there are.
+//
+// The calculator's rule is that the longest delimiter is replaced
+// everywhere first, then the next longest, and so on.  The single pass
+// gives the same tokens only if no two delimiters can overlap in the text,
+// which covers the default delimiters and any set of single characters.
+// Sets whose delimiters can overlap, such as [xyz][wx], are split by
+// applying that rule literally instead, and are never cut.
+class Delimiter_Matcher
+{
+	public:
+
+		Delimiter_Matcher( const std::set<std::string> & delimiters );
+
+		// Size of the longest delimiter starting at pos, or zero if none does.
+		size_t match( std::string_view text, size_t pos ) const;
+
+		void split( std::string_view text, Token_Visitor_Interface & visitor ) const;
+
+		// First position at or after pos where text can be cut in two and
+		// each half split on its own without changing the tokens: a delimiter
+		// starts there and the byte before it is not part of any delimiter.
+		// Returns text.size() when there is no such position, and always for
+		// delimiters that can overlap.
+		size_t next_safe_cut( std::string_view text, size_t pos ) const;
+
+		// Last such position at or before pos, or zero if there is none or
+		// the delimiters can overlap.
+		size_t previous_safe_cut( std::string_view text, size_t pos ) const;
+
+		size_t longest_delimiter_size() const;
+
+		// False if matches of two different delimiters can overlap, or a
+		// delimiter other than "," holds a comma, so that split() cannot use
+		// the single pass.
+		bool is_single_pass() const;
+
+	private:
+
+		bool is_safe_cut( std::string_view text, size_t pos ) const;
+		void split_longest_first( std::string_view text, Token_Visitor_Interface & visitor ) const;
+		static bool matches_never_overlap( const std::set<std::string> & delimiters );
+
+		struct Node
+		{
+			uint32_t first_edge;
+			uint32_t edge_count;
+			uint32_t match_size;
+		};
+
+		struct Edge
+		{
+			unsigned char byte;
+			uint32_t child;
+		};
+
+		uint32_t find_child( uint32_t node, unsigned char byte ) const;
+
+		static constexpr uint32_t no_node = 0;
+
+		std::array<uint32_t, 256> m_root;
+		std::array<bool, 256> m_is_delimiter_byte;
+		std::vector<Node> m_nodes;
+		std::vector<Edge> m_edges;
+		size_t m_longest_delimiter_size;
+		bool m_is_single_pass;
+		std::vector<std::string> m_longest_first;
+};
+
+#endif /*DELIMITER_MATCHER_H*/
+
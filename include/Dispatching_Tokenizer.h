@@ -0,0 +1,67 @@
+#ifndef DISPATCHING_TOKENIZER_H
+#define DISPATCHING_TOKENIZER_H
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Fixed_Delimiter_Tokenizer.h"
+#include "Tokenizer.h"
+#include "Tokenizer_Interface.h"
+
+// A Tokenizer that sends expressions whose header was registered with
+// register_format() to a compile-time specialised Fixed_Delimiter_Tokenizer
+// and everything else to the generic Tokenizer.  Register formats before
+// sharing the tokenizer between threads.
+class Dispatching_Tokenizer : public Tokenizer_Interface
+{
+	public:
+
+		Dispatching_Tokenizer();
+
+		// Registers the format that adds Extra_Delimiters to "," and "\n":
+		// no header at all for an empty list, "//;\n" and "//[;]\n" for a
+		// single ';', and "//[a][b]\n" for several, in the order given.
+		template<char... Extra_Delimiters>
+		void register_format()
+		{
+			static_assert( ((Extra_Delimiters != '[') && ...) && ((Extra_Delimiters != ']') && ...),
+			               "brackets cannot be written in a dynamic delimiter header" );
+
+			const Body_Splitter split = &Fixed_Delimiter_Tokenizer<',', '\n', Extra_Delimiters...>::template split<Token_Visitor_Interface>;
+
+			if( sizeof...(Extra_Delimiters) == 0 )
+			{
+				m_formats.emplace_back( std::string(), split );
+				return;
+			}
+
+			std::string dynamic_header( "//" );
+			((dynamic_header += std::string{ '[', Extra_Delimiters, ']' }), ...);
+			dynamic_header += '\n';
+			m_formats.emplace_back( dynamic_header, split );
+
+			if( sizeof...(Extra_Delimiters) == 1 )
+			{
+				m_formats.emplace_back( std::string{ '/', '/', Extra_Delimiters..., '\n' }, split );
+			}
+		}
+
+		std::vector<std::string> parse_tokens( const std::string & expression ) const override;
+		void visit_tokens( std::string_view expression, Token_Visitor_Interface & visitor ) const override;
+		void visit_body_tokens( std::string_view body, const Expression_Format & format, Token_Visitor_Interface & visitor ) const override;
+		void visit_source_tokens( Byte_Source_Interface & source, Token_Visitor_Interface & visitor ) const override;
+		std::unique_ptr<Chunked_Expression_Interface> cut_into_chunks( std::string_view expression, size_t max_chunks ) const override;
+
+		const Tokenizer & generic_tokenizer() const;
+
+	private:
+
+		typedef void (*Body_Splitter)( std::string_view body, Token_Visitor_Interface & visitor );
+
+		std::vector<std::pair<std::string, Body_Splitter>> m_formats;
+		const Tokenizer m_generic_tokenizer;
+};
+
+#endif /*DISPATCHING_TOKENIZER_H*/
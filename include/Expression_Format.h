@@ -0,0 +1,38 @@
+#ifndef EXPRESSION_FORMAT_H
+#define EXPRESSION_FORMAT_H
+
+#include <memory>
+#include <set>
+#include <string>
+
+#include "Delimiter_Header_Cache.h"
+
+// The delimiters of an expression, compiled once up front so that bodies
+// can be split without a "//...\n" header in front of them.  Copies share
+// the compiled matcher.  Formats are made from a header with
+// Tokenizer::compile_format() or from a set of delimiters here; the
+// default-constructed format splits on "," and "\n" only.
+class Expression_Format
+{
+	public:
+
+		typedef Delimiter_Header_Cache::Compiled_Header Compiled_Header;
+
+		Expression_Format();
+		explicit Expression_Format( std::shared_ptr<const Compiled_Header> p_compiled );
+
+		// The default delimiters are always included, as they are for a
+		// header.
+		static Expression_Format from_delimiters( const std::set<std::string> & delimiters );
+
+		static const std::set<std::string> & default_delimiters();
+
+		const Delimiter_Matcher & matcher() const;
+		bool is_default_format() const;
+
+	private:
+
+		std::shared_ptr<const Compiled_Header> mp_compiled;
+};
+
+#endif /*EXPRESSION_FORMAT_H*/
@@ -0,0 +1,20 @@
+#ifndef FD_BYTE_SOURCE_H
+#define FD_BYTE_SOURCE_H
+
+#include "Byte_Source_Interface.h"
+
+// Reads from a POSIX file descriptor, which stays owned by the caller.
+class Fd_Byte_Source : public Byte_Source_Interface
+{
+	public:
+
+		Fd_Byte_Source( int fd );
+
+		size_t read( char * buffer, size_t size ) override;
+
+	private:
+
+		const int m_fd;
+};
+
+#endif /*FD_BYTE_SOURCE_H*/
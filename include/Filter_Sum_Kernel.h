@@ -0,0 +1,50 @@
+#ifndef FILTER_SUM_KERNEL_H
+#define FILTER_SUM_KERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Sums the numbers of an array that lie between zero and a limit, and says
+// whether any of them were negative, without a branch that depends on the
+// numbers: each vector of numbers is compared against the limit and zero,
+// the comparison masks zero out what is left out, and what is left is
+// widened into 64-bit lanes so that long inputs cannot wrap.  Like
+// Default_Delimiter_Scanner, the widest vector unit the CPU offers is used.
+// A negative limit leaves out every number.
+class Filter_Sum_Kernel
+{
+	public:
+
+		enum class Kernel { scalar, sse2, avx2, best_available };
+
+		struct Result
+		{
+			int64_t total;
+			bool has_negative_numbers;
+		};
+
+		Filter_Sum_Kernel( Kernel kernel = Kernel::best_available );
+
+		Result filter_sum( const int * numbers, size_t count, int max_number ) const;
+
+		Kernel kernel() const;
+
+		static bool is_supported( Kernel kernel );
+
+		// A kernel of the best available kind, chosen once for the process.
+		static const Filter_Sum_Kernel & best_available();
+
+	private:
+
+		typedef Result (*Function)( const int * numbers, size_t count, int max_number );
+
+		static Result filter_sum_scalar( const int * numbers, size_t count, int max_number );
+		static Result filter_sum_sse2( const int * numbers, size_t count, int max_number );
+		static Result filter_sum_avx2( const int * numbers, size_t count, int max_number );
+		static Function function_for( Kernel kernel );
+
+		Kernel m_kernel;
+		Function m_filter_sum;
+};
+
+#endif /*FILTER_SUM_KERNEL_H*/
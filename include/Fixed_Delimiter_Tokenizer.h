@@ -0,0 +1,80 @@
+#ifndef FIXED_DELIMITER_TOKENIZER_H
+#define FIXED_DELIMITER_TOKENIZER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Token_Visitor_Interface.h"
+
+// Splits on a set of single-character delimiters fixed at compile time,
+// e.g. Fixed_Delimiter_Tokenizer<',', '\n', ';'>.  The delimiter test is a
+// chain of comparisons the compiler can fold into the loop, with no
+// delimiter set to search.  The text is taken to be a body without a
+// "//...\n" header; Dispatching_Tokenizer routes headers to the right
+// instantiation.
+template<char... Delimiters>
+class Fixed_Delimiter_Tokenizer
+{
+	public:
+
+		static_assert( sizeof...(Delimiters) > 0, "at least one delimiter is needed" );
+
+		static constexpr bool is_delimiter( char c )
+		{
+			return ((c == Delimiters) || ...);
+		}
+
+		// Visitor is usually Token_Visitor_Interface, but a concrete type
+		// lets the compiler inline the token handling too.
+		template<typename Visitor>
+		static void split( std::string_view text, Visitor & visitor )
+		{
+			size_t token_start = 0;
+
+			for( size_t pos = 0; pos < text.size(); ++pos )
+			{
+				if( is_delimiter(text[pos]) )
+				{
+					if( pos > token_start )
+					{
+						visitor.token_found( text.substr(token_start, pos - token_start) );
+					}
+
+					token_start = pos + 1;
+				}
+			}
+
+			if( token_start < text.size() )
+			{
+				visitor.token_found( text.substr(token_start) );
+			}
+		}
+
+		std::vector<std::string> parse_tokens( const std::string & expression ) const
+		{
+			Token_Collector collector;
+			split( expression, collector );
+			return collector.tokens;
+		}
+
+		template<typename Visitor>
+		void visit_tokens( std::string_view expression, Visitor & visitor ) const
+		{
+			split( expression, visitor );
+		}
+
+	private:
+
+		struct Token_Collector
+		{
+			void token_found( std::string_view token )
+			{
+				tokens.emplace_back( token );
+			}
+
+			std::vector<std::string> tokens;
+		};
+};
+
+#endif /*FIXED_DELIMITER_TOKENIZER_H*/
@@ -0,0 +1,21 @@
+#ifndef ISTREAM_BYTE_SOURCE_H
+#define ISTREAM_BYTE_SOURCE_H
+
+#include <istream>
+
+#include "Byte_Source_Interface.h"
+
+class Istream_Byte_Source : public Byte_Source_Interface
+{
+	public:
+
+		Istream_Byte_Source( std::istream & input );
+
+		size_t read( char * buffer, size_t size ) override;
+
+	private:
+
+		std::istream & m_input;
+};
+
+#endif /*ISTREAM_BYTE_SOURCE_H*/
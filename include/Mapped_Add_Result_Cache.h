@@ -0,0 +1,87 @@
+#ifndef MAPPED_ADD_RESULT_CACHE_H
+#define MAPPED_ADD_RESULT_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Add_Result_Cache_Interface.h"
+
+// An add() result cache that lives in a memory-mapped file, so a restarted
+// process picks up where the last one left off instead of starting cold.
+// The file is a versioned header followed by fixed-size slots, grouped
+// into buckets that an expression's hash picks; within its bucket an
+// expression goes in the first free slot, or else the one a CLOCK hand
+// picks.  Nothing is read up front: a slot is only looked at, and its
+// checksum checked, when a lookup lands on it.  A file whose header does
+// not check out, or that was made with another capacity, is wiped and
+// started afresh.  Expressions and messages too long for a slot are not
+// cached.  Only one cache at a time may have the file open; another
+// attempt throws std::system_error, as do other failures to open or map
+// it.
+class Mapped_Add_Result_Cache : public Add_Result_Cache_Interface
+{
+	public:
+
+		Mapped_Add_Result_Cache( const std::string & path, size_t capacity );
+		~Mapped_Add_Result_Cache();
+
+		Mapped_Add_Result_Cache( const Mapped_Add_Result_Cache & ) = delete;
+		Mapped_Add_Result_Cache & operator=( const Mapped_Add_Result_Cache & ) = delete;
+
+		bool find( std::string_view expression, Entry & entry ) override;
+		void store_total( std::string_view expression, int64_t total ) override;
+		void store_negative_numbers( std::string_view expression, const std::string & message ) override;
+		size_t max_expression_size() const override;
+
+		// Writes changed slots back to the file now rather than whenever
+		// the kernel gets round to it.
+		void flush();
+
+		// Whether the file already held a usable cache when it was opened.
+		bool opened_existing() const;
+
+		size_t hit_count() const;
+		size_t miss_count() const;
+		size_t corrupt_slot_count() const;
+		size_t capacity() const;
+
+		static const uint32_t format_version = 2;
+		static const size_t slot_size = 256;
+		static const size_t slots_per_bucket = 8;
+
+	private:
+
+		struct File_Header;
+		struct Slot;
+
+		void store( std::string_view expression, bool has_negative_numbers, int64_t total, std::string_view message );
+		bool map_existing();
+		void map_new();
+		Slot & slot( size_t index ) const;
+		Slot * find_slot( size_t bucket, uint64_t hash, std::string_view expression );
+		size_t victim( size_t bucket );
+		std::mutex & lock_for( size_t bucket ) const;
+
+		static const size_t lock_count = 64;
+
+		const std::string m_path;
+		size_t m_bucket_count;
+		int m_fd;
+		void * mp_data;
+		size_t m_size;
+		bool m_opened_existing;
+		std::unique_ptr<std::mutex[]> mp_locks;
+		std::vector<uint8_t> m_referenced;
+		std::vector<uint8_t> m_clock_hands;
+		std::atomic<size_t> m_hit_count;
+		std::atomic<size_t> m_miss_count;
+		std::atomic<size_t> m_corrupt_slot_count;
+};
+
+#endif /*MAPPED_ADD_RESULT_CACHE_H*/
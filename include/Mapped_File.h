@@ -0,0 +1,43 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+
+// A whole file mapped read-only into memory for one front-to-back pass.
+// Throws std::system_error if the file cannot be opened or mapped, which
+// includes anything that is not a regular file.  A file that reports a size
+// of zero maps as empty, even one such as those under /proc whose contents
+// are only made up as they are read; is_mappable() tells them apart from
+// files that can be mapped.
+class Mapped_File
+{
+	public:
+
+		Mapped_File( const std::string & path );
+
+		// Maps the file open on fd, which stays owned by the caller.  path
+		// is only used in error messages.
+		Mapped_File( int fd, const std::string & path );
+
+		~Mapped_File();
+
+		Mapped_File( const Mapped_File & ) = delete;
+		Mapped_File & operator=( const Mapped_File & ) = delete;
+
+		std::string_view contents() const;
+
+		// Whether fd is a regular file with a size, whose contents are all
+		// there is to map.  Pipes, devices and files that report no size
+		// have to be read instead.
+		static bool is_mappable( int fd );
+
+	private:
+
+		void map( int fd, const std::string & path );
+
+		void * mp_data;
+		size_t m_size;
+};
+
+#endif /*MAPPED_FILE_H*/
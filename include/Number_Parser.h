@@ -0,0 +1,26 @@
+#ifndef NUMBER_PARSER_H
+#define NUMBER_PARSER_H
+
+#include <string_view>
+
+// Converts a token the way std::stoi would - leading white space, an
+// optional sign and as many decimal digits as follow - without allocating
+// or throwing.  Positive numbers with more than four significant digits
+// can never be added, so they are reported as too_large from their length
+// alone instead of being converted.
+class Number_Parser
+{
+	public:
+
+		enum class Result { number, too_large, invalid, out_of_range };
+
+		Result parse( std::string_view token, int & number ) const;
+
+	private:
+
+		static const size_t max_significant_digits = 4;
+		static const size_t max_int_digits = 10;
+};
+
+#endif /*NUMBER_PARSER_H*/
+
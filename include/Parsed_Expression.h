@@ -0,0 +1,83 @@
+#ifndef PARSED_EXPRESSION_H
+#define PARSED_EXPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Sum_Accumulator.h"
+
+class Tokenizer_Interface;
+
+// The tokens of an expression, kept so that single tokens can be replaced,
+// inserted or erased and the total brought up to date in O(log n) instead
+// of adding the whole expression again.  The tokens sit in a treap ordered
+// by position, each node holding the filtered sum and the number of
+// negatives below it.  Tokens follow the same rules as add(): numbers over
+// one thousand count for nothing and negatives make total() throw.
+class Parsed_Expression
+{
+	public:
+
+		// Throws as add() would for a token that is not a number or does
+		// not fit in an int, but not for negatives.
+		Parsed_Expression( const Tokenizer_Interface & tokenizer, const std::string & expression );
+
+		size_t token_count() const;
+		const std::string & token( size_t index ) const;
+
+		// Each throws as the constructor does for a bad token, leaving the
+		// expression as it was.
+		void replace( size_t index, std::string_view token );
+		void insert( size_t index, std::string_view token );
+		void erase( size_t index );
+
+		// What add() would return for the expression, throwing as add()
+		// would if it holds negatives or, with overflow checking on, if the
+		// total does not fit in an int.
+		int total() const;
+		size_t negative_count() const;
+
+		// As String_Calculator::set_overflow_checking(): total() throws
+		// std::overflow_error when the total does not fit in an int, where
+		// otherwise it would return it wrapped around.  Off by default.
+		void set_overflow_checking( bool enabled );
+
+	private:
+
+		static const uint32_t no_node = static_cast<uint32_t>( -1 );
+
+		struct Node
+		{
+			std::string token;
+			int number;
+			int value;
+			uint32_t priority;
+			uint32_t left;
+			uint32_t right;
+			size_t size;
+			int64_t sum;
+			size_t negative_count;
+		};
+
+		uint32_t new_node( std::string_view token );
+		void set_token( Node & node, std::string_view token );
+		void update( uint32_t node );
+		size_t size_of( uint32_t node ) const;
+		uint32_t merge( uint32_t left, uint32_t right );
+		void split( uint32_t node, size_t count, uint32_t & left, uint32_t & right );
+		uint32_t find( size_t index ) const;
+		void collect_negatives( uint32_t node, Sum_Accumulator & accumulator ) const;
+		int checked_total( int64_t total ) const;
+
+		std::vector<Node> m_nodes;
+		std::vector<uint32_t> m_free_nodes;
+		uint32_t m_root;
+		uint32_t m_random_state;
+		Sum_Accumulator m_classifier;
+		bool m_checks_overflow;
+};
+
+#endif /*PARSED_EXPRESSION_H*/
@@ -0,0 +1,106 @@
+#ifndef STAGE_STATS_H
+#define STAGE_STATS_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Where add() spends its time.  The tokenizer splits, converts, filters
+// and sums in a single pass, so those are one stage, tokenize, which also
+// includes the header stage: finding the "//...\n" header and looking up
+// or compiling its delimiters.
+enum class Add_Stage { header, tokenize, negative_check, notify };
+
+struct Stage_Counters
+{
+	uint64_t calls;
+	uint64_t nanoseconds;
+	uint64_t bytes;
+	uint64_t tokens;
+};
+
+// Counters for each stage of add(), kept per thread so that recording one
+// costs no more than a few uncontended stores, and summed over every
+// thread by snapshot().  Recording is opt-in: it is only compiled in where
+// STRING_CALCULATOR_STATS is defined, and otherwise snapshot() returns
+// zeros.  The macro changes what this header declares, so it must be
+// defined, or not, for the whole build rather than file by file.
+class Stage_Stats
+{
+	public:
+
+		static const size_t stage_count = 4;
+
+		struct Snapshot
+		{
+			const Stage_Counters & operator[]( Add_Stage stage ) const
+			{
+				return stages[static_cast<size_t>(stage)];
+			}
+
+			std::array<Stage_Counters, stage_count> stages;
+		};
+
+#ifndef STRING_CALCULATOR_STATS
+		static constexpr bool enabled = false;
+
+		static Snapshot snapshot() { return Snapshot(); }
+		static void reset() {}
+		static void record( Add_Stage, uint64_t, uint64_t, uint64_t ) {}
+#else
+		static constexpr bool enabled = true;
+
+		static Snapshot snapshot();
+		static void reset();
+		static void record( Add_Stage stage, uint64_t nanoseconds, uint64_t bytes, uint64_t tokens );
+#endif
+};
+
+// Times the scope it lives in and records it against a stage, along with
+// whatever bytes and tokens were counted in the meantime.
+#ifndef STRING_CALCULATOR_STATS
+class Stage_Timer
+{
+	public:
+
+		explicit Stage_Timer( Add_Stage ) {}
+
+		void add_bytes( uint64_t ) {}
+		void add_tokens( uint64_t ) {}
+};
+#else
+class Stage_Timer
+{
+	public:
+
+		explicit Stage_Timer( Add_Stage stage ) :
+			m_stage( stage ),
+			m_start( std::chrono::steady_clock::now() ),
+			m_bytes( 0 ),
+			m_tokens( 0 )
+		{
+		}
+
+		~Stage_Timer()
+		{
+			const auto elapsed = std::chrono::steady_clock::now() - m_start;
+			Stage_Stats::record( m_stage, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), m_bytes, m_tokens );
+		}
+
+		Stage_Timer( const Stage_Timer & ) = delete;
+		Stage_Timer & operator=( const Stage_Timer & ) = delete;
+
+		void add_bytes( uint64_t bytes ) { m_bytes += bytes; }
+		void add_tokens( uint64_t tokens ) { m_tokens += tokens; }
+
+	private:
+
+		const Add_Stage m_stage;
+		const std::chrono::steady_clock::time_point m_start;
+		uint64_t m_bytes;
+		uint64_t m_tokens;
+};
+#endif
+
+#endif /*STAGE_STATS_H*/
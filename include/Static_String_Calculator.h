@@ -0,0 +1,78 @@
+#ifndef STATIC_STRING_CALCULATOR_H
+#define STATIC_STRING_CALCULATOR_H
+
+#include <string>
+
+#include "Sum_Accumulator.h"
+
+// Observer for Static_String_Calculator that does nothing, and so costs
+// nothing once inlined.
+class Null_Add_Observer
+{
+	public:
+
+		void add_occurred( const std::string & /*expression*/, int /*result*/ )
+		{
+		}
+};
+
+// String_Calculator with the tokenizer and observer fixed at compile time.
+// Nothing on the add() path is called through a virtual function, so the
+// compiler is free to inline the tokenizer's loop and the observer into
+// add().  Tokenizer_Type needs a visit_tokens( std::string_view, Visitor & )
+// that accepts a Sum_Accumulator, and Observer_Type an add_occurred() like
+// Add_Observer_Interface's.
+template<typename Tokenizer_Type, typename Observer_Type = Null_Add_Observer>
+class Static_String_Calculator
+{
+	public:
+
+		explicit Static_String_Calculator( const Tokenizer_Type & tokenizer ) :
+			m_add_call_count( 0 ),
+			m_tokenizer( tokenizer ),
+			m_observer( null_observer() )
+		{
+		}
+
+		Static_String_Calculator( const Tokenizer_Type & tokenizer, Observer_Type & observer ) :
+			m_add_call_count( 0 ),
+			m_tokenizer( tokenizer ),
+			m_observer( observer )
+		{
+		}
+
+		int add( const std::string & expression )
+		{
+			++m_add_call_count;
+
+			Sum_Accumulator accumulator;
+			m_tokenizer.visit_tokens( expression, accumulator );
+
+			accumulator.throw_if_has_negative_number();
+
+			int total = accumulator.total();
+
+			m_observer.add_occurred( expression, total );
+
+			return total;
+		}
+
+		int get_called_count() const
+		{
+			return m_add_call_count;
+		}
+
+	private:
+
+		static Null_Add_Observer & null_observer()
+		{
+			static Null_Add_Observer observer;
+			return observer;
+		}
+
+		int m_add_call_count;
+		const Tokenizer_Type & m_tokenizer;
+		Observer_Type & m_observer;
+};
+
+#endif /*STATIC_STRING_CALCULATOR_H*/
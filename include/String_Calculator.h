@@ -1,34 +1,123 @@
 #ifndef STRING_CALCULATOR_H
 #define STRING_CALCULATOR_H
 
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory_resource>
 #include <string>
-#include <vector>
+
+#include "Add_Result.h"
 
 class Add_Observer_Interface;
+class Add_Result_Cache_Interface;
+class Byte_Source_Interface;
+class Expression_Format;
+class Mapped_File;
+class Sum_Accumulator;
 class Tokenizer_Interface;
+class Work_Stealing_Executor;
 
 class String_Calculator
 {
 	public:
 
-		String_Calculator( Tokenizer_Interface & tokenizer );
-		String_Calculator( Tokenizer_Interface & tokenizer,  Add_Observer_Interface & observer );
+		// Scratch memory for each call comes from a small arena inside the
+		// calculator, which is reset at the start of every call; only what
+		// does not fit is taken from p_resource.
+		String_Calculator( Tokenizer_Interface & tokenizer, std::pmr::memory_resource * p_resource = std::pmr::get_default_resource() );
+		String_Calculator( Tokenizer_Interface & tokenizer,  Add_Observer_Interface & observer, std::pmr::memory_resource * p_resource = std::pmr::get_default_resource() );
+
+		String_Calculator( const String_Calculator & ) = delete;
+		String_Calculator & operator=( const String_Calculator & ) = delete;
 
 		int add( const std::string & expression );
+
+		// As above, but with the expression cut into chunks at delimiter
+		// boundaries that are summed on the executor's threads.  Only worth
+		// it for very large expressions; small ones are not cut at all.
+		int add( const std::string & expression, Work_Stealing_Executor & executor );
+
+		// As add(), but for a body without a delimiter header, split
+		// according to a format compiled beforehand.
+		int add( const std::string & body, const Expression_Format & format );
+
+		// As add(), but reading the expression from a stream or a file
+		// descriptor a chunk at a time instead of holding it all in memory.
+		// The observer is notified with an empty expression.
+		int add( std::istream & input );
+		int add_fd( int fd );
+
+		// As add(), but summing the file at path straight from a read-only
+		// memory mapping.  Pipes, devices and files that report no size,
+		// such as those under /proc, are read as add_fd() reads them
+		// instead.  The observer is notified with an empty expression.
+		int add_file( const std::string & path );
+
+		// Evaluates count expressions, writing each result or error message
+		// to the same index of the caller's arrays.  An item that add() would
+		// have thrown for gets a zero result and the exception's message;
+		// successful items get an empty message.  The observer is notified
+		// for each successful item, in order.  Each item is still tokenized
+		// and notified on its own, so on valid input this is barely cheaper
+		// than calling add() in a loop; what it saves is the exception for
+		// each item that fails.
+		void add_batch( const std::string * expressions, size_t count, int * results, std::string * error_messages );
+
+		// As above, but with the items spread over the executor's threads.
+		// The tokenizer must be safe to share between threads.  Results and
+		// observer notifications come out in the same order as the serial
+		// overload's.
+		void add_batch( const std::string * expressions, size_t count, int * results, std::string * error_messages, Work_Stealing_Executor & executor );
+
+		// As add(), but reporting bad input in the result instead of
+		// throwing, which is much cheaper when a large share of inputs are
+		// rejected.  At most max_reported_negatives negatives are kept, with
+		// their positions; the error message is only built if asked for.
+		Add_Result try_add( const std::string & expression, size_t max_reported_negatives = default_max_reported_negatives );
+
+		// Has add( expression ) look expressions up in cache before
+		// evaluating them and store what it makes of them afterwards.
+		// Expressions longer than the cache's max_expression_size() bypass
+		// it.  The observer is notified of cached totals as of any other.
+		// The cache may be shared with calculators on other threads,
+		// provided they use equivalent tokenizers.  Pass nullptr to stop
+		// using it.
+		void set_result_cache( Add_Result_Cache_Interface * p_cache );
+
+		// Has the add()s throw std::overflow_error, add_batch() report an
+		// error for the item and try_add() return a total_out_of_range
+		// error when a total does not fit in an int, where otherwise the
+		// total would be returned wrapped around.  Off by default.
+		void set_overflow_checking( bool enabled );
+
 		int get_called_count() const;
 
+		static const size_t default_max_reported_negatives = 16;
+
 	private:
 
-		std::vector<int> parse_numbers( const std::string & expression ) const;
-		int sum( const std::vector<int> & addends ) const;
-		std::vector<int> strings_to_ints( const std::vector<std::string> & strs ) const;
-		void throw_if_has_negative_number( const std::vector<int> & addends ) const;
+		int add_from( Byte_Source_Interface & source );
+		int add_mapped( const Mapped_File & file );
+		int add_through_cache( const std::string & expression );
+		bool evaluate( const std::string & expression, Sum_Accumulator & accumulator, int & result, std::string & error_message ) const;
+		void throw_if_has_negative_number( const Sum_Accumulator & accumulator ) const;
+		int checked_total( int64_t total ) const;
 		void notify_add_occurred( const std::string & expression, int result ) const;
-		std::vector<int> filter_out_large_numbers( const std::vector<int> & numbers ) const;
+		std::pmr::memory_resource * reset_scratch();
+		static size_t position_in( const std::string & expression, const char * p_token );
+
+		static const size_t min_chunk_size = 64 * 1024;
+		static const size_t chunks_per_thread = 4;
+		static const size_t scratch_buffer_size = 4 * 1024;
 
 		int m_add_call_count;
 		Tokenizer_Interface & m_tokenizer;
 		Add_Observer_Interface * const mp_observer;
+		Add_Result_Cache_Interface * mp_result_cache;
+		bool m_checks_overflow;
+		alignas(std::max_align_t) std::byte m_scratch_buffer[scratch_buffer_size];
+		std::pmr::monotonic_buffer_resource m_scratch;
 };
 
 #endif /*STRING_CALCULATOR_H*/
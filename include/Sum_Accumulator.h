@@ -0,0 +1,89 @@
+#ifndef SUM_ACCUMULATOR_H
+#define SUM_ACCUMULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Number_Parser.h"
+#include "Stage_Stats.h"
+#include "Token_Visitor_Interface.h"
+
+// Applies the calculator's rules to tokens as the tokenizer finds them:
+// each token is converted, negatives are remembered for the error message,
+// numbers over one thousand are skipped and the rest are summed into a
+// 64-bit total that a long input cannot wrap.
+class Sum_Accumulator final : public Token_Visitor_Interface
+{
+	public:
+
+		Sum_Accumulator();
+
+		// Negatives are remembered in memory from p_resource.
+		explicit Sum_Accumulator( std::pmr::memory_resource * p_resource );
+
+		void token_found( std::string_view token ) override;
+		void number_found( std::string_view token, int number ) override;
+
+		// Filtered and summed with Filter_Sum_Kernel.
+		void numbers_found( const std::string_view * tokens, const int * numbers, size_t count ) override;
+
+		void add_number( int number );
+
+		// As add_number() for each of count numbers, filtered and summed
+		// with Filter_Sum_Kernel.
+		void add_numbers( const int * numbers, size_t count );
+
+		// Folds in what another accumulator saw, as if its tokens had come
+		// after this one's.
+		void merge( const Sum_Accumulator & other );
+
+		// The total cut down to an int, which is only the true total if
+		// total_fits_in_int().
+		int total() const;
+		int64_t wide_total() const;
+		bool total_fits_in_int() const;
+
+		// Throws std::overflow_error with total_out_of_range_message() unless
+		// total_fits_in_int().
+		void throw_if_total_out_of_range() const;
+		static bool fits_in_int( int64_t total );
+		static const char * total_out_of_range_message();
+
+		// Tokens seen since construction or reset(), counted only when
+		// Stage_Stats is enabled.
+		size_t token_count() const;
+		bool has_negative_numbers() const;
+		size_t negative_number_count() const;
+		int negative_number( size_t index ) const;
+
+		// Where the index-th negative's token starts, or nullptr if it was
+		// passed to add_number() directly.  Only meaningful while the text
+		// that was tokenized is still alive.
+		const char * negative_token( size_t index ) const;
+
+		std::string negative_numbers_message() const;
+		void throw_if_has_negative_number() const;
+
+		void reset();
+
+	private:
+
+		void add_number( int number, const char * p_token );
+		void add_numbers( const int * numbers, const std::string_view * tokens, size_t count );
+
+		static const int max_allowable_number = 1000;
+		static const size_t min_kernel_count = 8;
+
+		const Number_Parser m_number_parser;
+		int64_t m_total;
+		size_t m_token_count;
+		std::pmr::vector<int> m_negative_numbers;
+		std::pmr::vector<const char *> m_negative_tokens;
+};
+
+#endif /*SUM_ACCUMULATOR_H*/
+
@@ -0,0 +1,34 @@
+#ifndef TOKEN_VISITOR_INTERFACE_H
+#define TOKEN_VISITOR_INTERFACE_H
+
+#include <cstddef>
+#include <string_view>
+
+class Token_Visitor_Interface
+{
+	public:
+		virtual ~Token_Visitor_Interface() {}
+
+		// The token views are only valid for the duration of the call.
+		virtual void token_found( std::string_view token ) = 0;
+
+		// Called instead of token_found() when the tokenizer has already
+		// converted a plain decimal token such as "42" or "-7".
+		virtual void number_found( std::string_view token, int /*number*/ )
+		{
+			token_found( token );
+		}
+
+		// Called instead of number_found() for a run of count neighbouring
+		// tokens that the tokenizer converted in one go.
+		virtual void numbers_found( const std::string_view * tokens, const int * numbers, size_t count )
+		{
+			for( size_t i = 0; i < count; ++i )
+			{
+				number_found( tokens[i], numbers[i] );
+			}
+		}
+};
+
+#endif /*TOKEN_VISITOR_INTERFACE_H*/
+
@@ -1,30 +1,71 @@
 #ifndef TOKENIZER_H
 #define TOKENIZER_H
 
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 #include <utility>
 
+#include "Default_Delimiter_Scanner.h"
+#include "Delimiter_Header_Cache.h"
 #include "Tokenizer_Interface.h"
 
-class Tokenizer : public Tokenizer_Interface
+class Tokenizer final : public Tokenizer_Interface
 {
 	public:
 
+		// The buffers that streaming and chunking need for the length of a
+		// call come from p_scratch_resource, which must be safe to use from
+		// every thread that shares the tokenizer.
+		explicit Tokenizer( size_t header_cache_capacity = default_header_cache_capacity, std::pmr::memory_resource * p_scratch_resource = std::pmr::get_default_resource() );
+
 		std::vector<std::string> parse_tokens( const std::string & expression ) const override;
+		void visit_tokens( std::string_view expression, Token_Visitor_Interface & visitor ) const override;
+		void visit_body_tokens( std::string_view body, const Expression_Format & format, Token_Visitor_Interface & visitor ) const override;
+		void visit_source_tokens( Byte_Source_Interface & source, Token_Visitor_Interface & visitor ) const override;
+		std::unique_ptr<Chunked_Expression_Interface> cut_into_chunks( std::string_view expression, size_t max_chunks ) const override;
+
+		// Compiles a header such as "//;\n" or "//[***][%]\n" into a format
+		// for visit_body_tokens().  An empty header gives the default format;
+		// anything else that is not exactly one header throws
+		// std::invalid_argument.
+		Expression_Format compile_format( std::string_view header ) const;
+
+		// Length of the "//...\n" header at the front of expression, or zero
+		// if it has none.
+		size_t delimiter_header_size( std::string_view expression ) const;
+
+		// False while expression could be the start of a header that more
+		// input would complete or change.
+		bool is_header_complete( std::string_view expression ) const;
+
+		const Delimiter_Header_Cache & header_cache() const;
+
+		static const size_t default_header_cache_capacity = 64;
 
 	private:
 
-		std::pair<std::set<std::string>, size_t> parse_delimiter_header( const std::string & expression ) const;
-		bool parse_dynamic_delimiter_header( const std::string & expression, std::set<std::string> & delimiters, size_t & header_size ) const;
-		bool parse_static_delimiter_header( const std::string & expression, std::set<std::string> & delimiters, size_t & header_size ) const;
-		std::vector<std::string> split( const std::string & expression, const std::set<std::string> & delimiters ) const;
-		std::vector<std::string> split( const std::string & expression, const std::string & delimiter ) const;
-		std::string replace_all( const std::string & in_this_str, const std::string & from_value, const std::string & to_value ) const;
-		std::string replace_all( const std::string & in_this_str, const std::set<std::string> & from_values, const std::string & to_value ) const;
-		std::vector<std::string> sort_longest_first( const std::set<std::string> & unsorted ) const;
+		typedef Delimiter_Header_Cache::Compiled_Header Compiled_Header;
+
+		std::shared_ptr<const Compiled_Header> compiled_header( std::string_view header ) const;
+		std::shared_ptr<const Compiled_Header> compile_header( std::string_view header ) const;
+		void split_body( const Compiled_Header & header, std::string_view body, Token_Visitor_Interface & visitor ) const;
+		const std::set<std::string> & default_delimiters() const;
+		std::pair<std::set<std::string>, size_t> parse_delimiter_header( std::string_view expression ) const;
+		bool parse_dynamic_delimiter_header( std::string_view expression, std::set<std::string> & delimiters, size_t & header_size ) const;
+		bool parse_static_delimiter_header( std::string_view expression, std::set<std::string> & delimiters, size_t & header_size ) const;
+		std::vector<std::string> split( std::string_view expression, const std::string & delimiter ) const;
 		std::string ctos( char c ) const;
+
+		static const size_t source_chunk_size = 64 * 1024;
+
+		std::pmr::memory_resource * const mp_scratch_resource;
+		const Default_Delimiter_Scanner m_default_delimiter_scanner;
+		const std::shared_ptr<const Compiled_Header> mp_default_header;
+		mutable Delimiter_Header_Cache m_header_cache;
 };
 
 #endif /*TOKENIZER_H*/
@@ -1,9 +1,16 @@
 #ifndef TOKENIZER_INTERFACE_H
 #define TOKENIZER_INTERFACE_H
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "Byte_Source_Interface.h"
+#include "Chunked_Expression_Interface.h"
+#include "Expression_Format.h"
+#include "Token_Visitor_Interface.h"
+
 class Tokenizer_Interface
 {
 	public:
@@ -11,7 +18,78 @@ class Tokenizer_Interface
 		virtual ~Tokenizer_Interface() {};
 
 		virtual std::vector<std::string> parse_tokens( const std::string & ) const = 0;
+
+		// Hands each token to the visitor in order.  Implementations that can
+		// should pass views into the caller's expression rather than copies;
+		// the default falls back on parse_tokens().
+		virtual void visit_tokens( std::string_view expression, Token_Visitor_Interface & visitor ) const
+		{
+			for( const std::string & token : parse_tokens(std::string(expression)) )
+			{
+				visitor.token_found( token );
+			}
+		}
+
+		// Hands each token of a body that has no delimiter header to the
+		// visitor in order, splitting it according to format instead.
+		virtual void visit_body_tokens( std::string_view body, const Expression_Format & format, Token_Visitor_Interface & visitor ) const
+		{
+			format.matcher().split( body, visitor );
+		}
+
+		// Hands each token of the expression read from source to the visitor
+		// in order.  Implementations that can should read in fixed-size
+		// chunks rather than holding the whole expression; the default reads
+		// it all and falls back on visit_tokens().
+		virtual void visit_source_tokens( Byte_Source_Interface & source, Token_Visitor_Interface & visitor ) const
+		{
+			std::string expression;
+			char buffer[4096];
+
+			for( size_t size = source.read(buffer, sizeof(buffer)); size > 0; size = source.read(buffer, sizeof(buffer)) )
+			{
+				expression.append( buffer, size );
+			}
+
+			visit_tokens( expression, visitor );
+		}
+
+		// Reads the delimiter header once and cuts the rest of the expression
+		// into at most max_chunks chunks, none of which splits a token or a
+		// delimiter.  The chunks refer to the caller's expression.  The
+		// default keeps the whole expression in a single chunk.
+		virtual std::unique_ptr<Chunked_Expression_Interface> cut_into_chunks( std::string_view expression, size_t /*max_chunks*/ ) const
+		{
+			return std::make_unique<Whole_Expression>( *this, expression );
+		}
+
+	private:
+
+		class Whole_Expression : public Chunked_Expression_Interface
+		{
+			public:
+
+				Whole_Expression( const Tokenizer_Interface & tokenizer, std::string_view expression ) :
+					m_tokenizer( tokenizer ),
+					m_expression( expression )
+				{
+				}
+
+				size_t chunk_count() const override
+				{
+					return 1;
+				}
+
+				void visit_chunk_tokens( size_t /*chunk*/, Token_Visitor_Interface & visitor ) const override
+				{
+					m_tokenizer.visit_tokens( m_expression, visitor );
+				}
+
+			private:
+
+				const Tokenizer_Interface & m_tokenizer;
+				const std::string_view m_expression;
+		};
 };
 
 #endif /*TOKENIZER_INTERFACE_H*/
-
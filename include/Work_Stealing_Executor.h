@@ -0,0 +1,53 @@
+#ifndef WORK_STEALING_EXECUTOR_H
+#define WORK_STEALING_EXECUTOR_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed pool of threads that runs a task for every index of a batch.
+// Indices are handed out as ranges; each worker keeps its own queue of
+// ranges and steals the oldest range from another worker once its own
+// queue runs dry.  Ranges are cut by weight rather than by count, so a
+// handful of expensive items end up in ranges of their own instead of
+// holding up the cheap items around them.  The calling thread takes part
+// in the work, and for_each() returns once every task has finished.
+class Work_Stealing_Executor
+{
+	public:
+
+		explicit Work_Stealing_Executor( size_t thread_count = std::thread::hardware_concurrency() );
+		~Work_Stealing_Executor();
+
+		Work_Stealing_Executor( const Work_Stealing_Executor & ) = delete;
+		Work_Stealing_Executor & operator=( const Work_Stealing_Executor & ) = delete;
+
+		// Calls task(i) once for each i in [0, count), weight(i) being its
+		// relative cost.  If a task throws, the remaining tasks still run and
+		// the first exception is rethrown here.
+		void for_each( size_t count, const std::function<size_t(size_t)> & weight, const std::function<void(size_t)> & task );
+
+		size_t thread_count() const;
+
+	private:
+
+		struct Job;
+
+		void worker_loop( size_t worker );
+		void run_worker( size_t worker, Job & job );
+
+		std::vector<std::thread> m_threads;
+		std::mutex m_for_each_mutex;
+		std::mutex m_mutex;
+		std::condition_variable m_job_posted;
+		std::condition_variable m_job_finished;
+		Job * mp_job;
+		size_t m_generation;
+		size_t m_busy_workers;
+		bool m_stopping;
+};
+
+#endif /*WORK_STEALING_EXECUTOR_H*/
@@ -0,0 +1,22 @@
+#include "Add_Observer_Batch_Adapter.h"
+
+
+Add_Observer_Batch_Adapter::Add_Observer_Batch_Adapter( Add_Observer_Interface & observer ) :
+	m_observer( observer )
+{
+}
+
+
+void Add_Observer_Batch_Adapter::add_occurred_batch( const Add_Event * events, size_t count )
+{
+	for( size_t i = 0; i < count; ++i )
+	{
+		m_observer.add_occurred( events[i].expression, events[i].result );
+	}
+}
+
+
+bool Add_Observer_Batch_Adapter::needs_expression() const
+{
+	return m_observer.needs_expression();
+}
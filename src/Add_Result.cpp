@@ -0,0 +1,115 @@
+#include "Add_Result.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+
+Add_Error::Add_Error( std::vector<Negative_Number> negative_numbers, size_t negative_number_count ) :
+	m_kind( Kind::negative_numbers ),
+	m_negative_numbers( std::move(negative_numbers) ),
+	m_negative_number_count( negative_number_count ),
+	m_description()
+{
+}
+
+
+Add_Error::Add_Error( Kind kind, std::string description ) :
+	m_kind( kind ),
+	m_negative_numbers(),
+	m_negative_number_count( 0 ),
+	m_description( std::move(description) )
+{
+}
+
+
+Add_Error::Kind Add_Error::kind() const
+{
+	return m_kind;
+}
+
+
+const std::vector<Negative_Number> & Add_Error::negative_numbers() const
+{
+	return m_negative_numbers;
+}
+
+
+size_t Add_Error::negative_number_count() const
+{
+	return m_negative_number_count;
+}
+
+
+std::string Add_Error::message() const
+{
+	if( m_kind != Kind::negative_numbers )
+	{
+		return m_description;
+	}
+
+	std::ostringstream message;
+	message << "negatives not allowed:";
+
+	for( const Negative_Number & number : m_negative_numbers )
+	{
+		message << " " << number.value;
+	}
+
+	if( m_negative_numbers.size() < m_negative_number_count )
+	{
+		message << " ...";
+	}
+
+	return message.str();
+}
+
+
+Add_Result::Add_Result( int value ) :
+	m_value( value ),
+	m_has_value( true ),
+	m_error( Add_Error::Kind::invalid_number, std::string() )
+{
+}
+
+
+Add_Result::Add_Result( Add_Error error ) :
+	m_value( 0 ),
+	m_has_value( false ),
+	m_error( std::move(error) )
+{
+}
+
+
+bool Add_Result::has_value() const
+{
+	return m_has_value;
+}
+
+
+Add_Result::operator bool() const
+{
+	return m_has_value;
+}
+
+
+int Add_Result::value() const
+{
+	if( !m_has_value )
+	{
+		throw std::logic_error( "Add_Result has no value" );
+	}
+
+	return m_value;
+}
+
+
+const Add_Error & Add_Result::error() const
+{
+	if( m_has_value )
+	{
+		throw std::logic_error( "Add_Result has no error" );
+	}
+
+	return m_error;
+}
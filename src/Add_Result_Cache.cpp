@@ -0,0 +1,189 @@
+#include "Add_Result_Cache.h"
+
+#include <functional>
+
+
+Add_Result_Cache::Add_Result_Cache( size_t capacity, size_t slots_per_shard, size_t max_expression_size ) :
+	m_slots_per_shard( (slots_per_shard == 0) ? 1 : slots_per_shard ),
+	m_max_expression_size( max_expression_size ),
+	m_shard_count( 1 ),
+	mp_shards()
+{
+	// A power of two, so that the shard is picked by masking the hash.
+	while( m_shard_count * m_slots_per_shard < capacity )
+	{
+		m_shard_count *= 2;
+	}
+
+	mp_shards.reset( new Shard[m_shard_count] );
+
+	for( size_t i = 0; i < m_shard_count; ++i )
+	{
+		mp_shards[i].slots.assign( m_slots_per_shard, Slot{ false, false, 0, std::string(), Entry{ false, 0, std::string() } } );
+		mp_shards[i].clock_hand = 0;
+		mp_shards[i].hit_count = 0;
+		mp_shards[i].miss_count = 0;
+	}
+}
+
+
+bool Add_Result_Cache::find( std::string_view expression, Entry & entry )
+{
+	if( expression.size() > m_max_expression_size )
+	{
+		return false;
+	}
+
+	const uint64_t hash = std::hash<std::string_view>()( expression );
+	Shard & shard = shard_for( hash );
+	std::lock_guard<std::mutex> lock( shard.mutex );
+
+	Slot * const p_slot = find_slot( shard, hash, expression );
+	if( p_slot == nullptr )
+	{
+		++shard.miss_count;
+		return false;
+	}
+
+	++shard.hit_count;
+	p_slot->referenced = true;
+
+	entry.has_negative_numbers = p_slot->entry.has_negative_numbers;
+	entry.total = p_slot->entry.total;
+	entry.negative_numbers_message.assign( p_slot->entry.negative_numbers_message );
+	return true;
+}
+
+
+void Add_Result_Cache::store_total( std::string_view expression, int64_t total )
+{
+	store( expression, false, total, std::string() );
+}
+
+
+void Add_Result_Cache::store_negative_numbers( std::string_view expression, const std::string & message )
+{
+	store( expression, true, 0, message );
+}
+
+
+size_t Add_Result_Cache::max_expression_size() const
+{
+	return m_max_expression_size;
+}
+
+
+size_t Add_Result_Cache::hit_count() const
+{
+	size_t count = 0;
+
+	for( size_t i = 0; i < m_shard_count; ++i )
+	{
+		std::lock_guard<std::mutex> lock( mp_shards[i].mutex );
+		count += mp_shards[i].hit_count;
+	}
+
+	return count;
+}
+
+
+size_t Add_Result_Cache::miss_count() const
+{
+	size_t count = 0;
+
+	for( size_t i = 0; i < m_shard_count; ++i )
+	{
+		std::lock_guard<std::mutex> lock( mp_shards[i].mutex );
+		count += mp_shards[i].miss_count;
+	}
+
+	return count;
+}
+
+
+double Add_Result_Cache::hit_rate() const
+{
+	const size_t hits = hit_count();
+	const size_t lookups = hits + miss_count();
+
+	return (lookups == 0) ? 0.0 : static_cast<double>( hits ) / static_cast<double>( lookups );
+}
+
+
+size_t Add_Result_Cache::capacity() const
+{
+	return m_shard_count * m_slots_per_shard;
+}
+
+
+// Another thread may have stored the same expression since this one
+// missed, in which case its slot is simply overwritten.
+void Add_Result_Cache::store( std::string_view expression, bool has_negative_numbers, int64_t total, const std::string & message )
+{
+	if( expression.size() > m_max_expression_size )
+	{
+		return;
+	}
+
+	const uint64_t hash = std::hash<std::string_view>()( expression );
+	Shard & shard = shard_for( hash );
+	std::lock_guard<std::mutex> lock( shard.mutex );
+
+	Slot * p_slot = find_slot( shard, hash, expression );
+	if( p_slot == nullptr )
+	{
+		p_slot = &victim( shard );
+		p_slot->occupied = true;
+		p_slot->hash = hash;
+		p_slot->expression.assign( expression );
+	}
+
+	p_slot->referenced = false;
+	p_slot->entry.has_negative_numbers = has_negative_numbers;
+	p_slot->entry.total = total;
+	p_slot->entry.negative_numbers_message.assign( message );
+}
+
+
+Add_Result_Cache::Shard & Add_Result_Cache::shard_for( uint64_t hash )
+{
+	return mp_shards[hash & (m_shard_count - 1)];
+}
+
+
+Add_Result_Cache::Slot * Add_Result_Cache::find_slot( Shard & shard, uint64_t hash, std::string_view expression )
+{
+	for( Slot & slot : shard.slots )
+	{
+		if( slot.occupied && (slot.hash == hash) && (slot.expression.size() == expression.size()) && (slot.expression == expression) )
+		{
+			return &slot;
+		}
+	}
+
+	return nullptr;
+}
+
+
+// An empty slot if there is one, otherwise the first slot the clock hand
+// reaches that has not been hit since it last came round.
+Add_Result_Cache::Slot & Add_Result_Cache::victim( Shard & shard )
+{
+	for( Slot & slot : shard.slots )
+	{
+		if( !slot.occupied )
+		{
+			return slot;
+		}
+	}
+
+	while( shard.slots[shard.clock_hand].referenced )
+	{
+		shard.slots[shard.clock_hand].referenced = false;
+		shard.clock_hand = (shard.clock_hand + 1) % shard.slots.size();
+	}
+
+	Slot & slot = shard.slots[shard.clock_hand];
+	shard.clock_hand = (shard.clock_hand + 1) % shard.slots.size();
+	return slot;
+}
@@ -0,0 +1,98 @@
+#include "Add_Session.h"
+
+#include "Delimiter_Matcher.h"
+#include "Tokenizer.h"
+
+
+Add_Session::Add_Session( const Tokenizer & tokenizer ) :
+	m_tokenizer( tokenizer ),
+	m_pending(),
+	m_has_format( false ),
+	m_format(),
+	m_committed(),
+	mp_committed_error(),
+	m_checks_overflow( false )
+{
+}
+
+
+int Add_Session::append( std::string_view fragment )
+{
+	if( mp_committed_error )
+	{
+		std::rethrow_exception( mp_committed_error );
+	}
+
+	m_pending.append( fragment );
+
+	if( !m_has_format )
+	{
+		if( !m_tokenizer.is_header_complete(m_pending) )
+		{
+			Sum_Accumulator accumulator;
+			m_tokenizer.visit_tokens( m_pending, accumulator );
+			accumulator.throw_if_has_negative_number();
+			return checked_total( accumulator );
+		}
+
+		const size_t header_size = m_tokenizer.delimiter_header_size( m_pending );
+		m_format = m_tokenizer.compile_format( std::string_view(m_pending).substr(0, header_size) );
+		m_pending.erase( 0, header_size );
+		m_has_format = true;
+	}
+
+	const Delimiter_Matcher & matcher = m_format.matcher();
+
+	if( m_pending.size() > matcher.longest_delimiter_size() )
+	{
+		const size_t cut = matcher.previous_safe_cut( m_pending, m_pending.size() - matcher.longest_delimiter_size() );
+
+		if( cut > 0 )
+		{
+			try
+			{
+				m_tokenizer.visit_body_tokens( std::string_view(m_pending).substr(0, cut), m_format, m_committed );
+			}
+			catch( ... )
+			{
+				mp_committed_error = std::current_exception();
+				throw;
+			}
+
+			m_pending.erase( 0, cut );
+		}
+	}
+
+	return total_with_pending();
+}
+
+
+void Add_Session::set_overflow_checking( bool enabled )
+{
+	m_checks_overflow = enabled;
+}
+
+
+// The pending tail is summed as if the expression ended with it.  Merging
+// only copies the committed negatives, of which there are none unless the
+// call is about to throw.
+int Add_Session::total_with_pending() const
+{
+	Sum_Accumulator all;
+	all.merge( m_committed );
+	m_tokenizer.visit_body_tokens( m_pending, m_format, all );
+
+	all.throw_if_has_negative_number();
+	return checked_total( all );
+}
+
+
+int Add_Session::checked_total( const Sum_Accumulator & accumulator ) const
+{
+	if( m_checks_overflow )
+	{
+		accumulator.throw_if_total_out_of_range();
+	}
+
+	return accumulator.total();
+}
@@ -0,0 +1,239 @@
+#include "Async_Add_Observer.h"
+
+namespace
+{
+	size_t round_up_to_power_of_two( size_t n )
+	{
+		size_t power = 1;
+		while( power < n )
+		{
+			power <<= 1;
+		}
+		return power;
+	}
+}
+
+
+Async_Add_Observer::Async_Add_Observer( Add_Observer_Interface & observer, size_t capacity, Overflow_Policy policy, size_t sample_every ) :
+	m_observer( observer ),
+	m_copy_expressions( observer.needs_expression() ),
+	m_policy( policy ),
+	m_sample_every( (sample_every == 0) ? 1 : sample_every ),
+	m_capacity( round_up_to_power_of_two(capacity) ),
+	mp_slots( new Slot[m_capacity] ),
+	m_push_pos( 0 ),
+	m_pop_pos( 0 ),
+	m_delivered_count( 0 ),
+	m_dropped_count( 0 ),
+	m_failed_count( 0 ),
+	m_overflow_count( 0 ),
+	m_stopping( false ),
+	m_drain_mutex(),
+	m_event_pushed(),
+	m_waiter_count( 0 ),
+	m_waiter_mutex(),
+	m_event_delivered(),
+	m_drain_thread()
+{
+	for( size_t i = 0; i < m_capacity; ++i )
+	{
+		mp_slots[i].sequence.store( i, std::memory_order_relaxed );
+		mp_slots[i].result = 0;
+
+		if( m_copy_expressions )
+		{
+			mp_slots[i].expression.reserve( reserved_expression_size );
+		}
+	}
+
+	m_drain_thread = std::thread( &Async_Add_Observer::drain_loop, this );
+}
+
+
+Async_Add_Observer::~Async_Add_Observer()
+{
+	m_stopping.store( true );
+	{
+		std::lock_guard<std::mutex> lock( m_drain_mutex );
+		m_event_pushed.notify_one();
+	}
+	m_drain_thread.join();
+}
+
+
+// Sleeps until is_done(), which is checked again after each delivery.
+template<typename Predicate>
+void Async_Add_Observer::wait_for_delivery( Predicate is_done )
+{
+	m_waiter_count.fetch_add( 1 );
+	{
+		std::unique_lock<std::mutex> lock( m_waiter_mutex );
+		m_event_delivered.wait( lock, is_done );
+	}
+	m_waiter_count.fetch_sub( 1 );
+}
+
+
+void Async_Add_Observer::add_occurred( const std::string & expression, int result )
+{
+	if( try_push(expression, result) )
+	{
+		return;
+	}
+
+	const bool must_wait = (m_policy == Overflow_Policy::block) ||
+		((m_policy == Overflow_Policy::sample) && (((m_overflow_count.fetch_add(1) + 1) % m_sample_every) == 0));
+
+	if( !must_wait )
+	{
+		m_dropped_count.fetch_add( 1 );
+		return;
+	}
+
+	wait_for_delivery( [&]{ return try_push( expression, result ); } );
+}
+
+
+void Async_Add_Observer::flush()
+{
+	const size_t pushed = m_push_pos.load();
+
+	wait_for_delivery( [&]{ return m_delivered_count.load() >= pushed; } );
+}
+
+
+size_t Async_Add_Observer::capacity() const
+{
+	return m_capacity;
+}
+
+
+size_t Async_Add_Observer::delivered_count() const
+{
+	return m_delivered_count.load();
+}
+
+
+size_t Async_Add_Observer::dropped_count() const
+{
+	return m_dropped_count.load();
+}
+
+
+size_t Async_Add_Observer::failed_count() const
+{
+	return m_failed_count.load();
+}
+
+
+// Bounded multi-producer queue after Dmitry Vyukov: each slot's sequence
+// number says whether it is free for the push at that position or holds
+// the event the consumer is waiting for.
+//
+// The stores that fill and free slots, the counts of delivered events and
+// waiters, and the loads that a thread checks before going to sleep are
+// all sequentially consistent, so a thread about to sleep and the thread
+// that would wake it cannot both miss each other's change.
+bool Async_Add_Observer::try_push( const std::string & expression, int result )
+{
+	size_t pos = m_push_pos.load( std::memory_order_relaxed );
+
+	while( true )
+	{
+		Slot & slot = mp_slots[pos & (m_capacity - 1)];
+		const size_t sequence = slot.sequence.load();
+
+		if( sequence == pos )
+		{
+			if( m_push_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) )
+			{
+				if( m_copy_expressions )
+				{
+					slot.expression.assign( expression );
+				}
+				slot.result = result;
+
+				slot.sequence.store( pos + 1 );
+
+				// Everything before this event has been delivered, so the
+				// background thread may have gone to sleep.
+				if( m_delivered_count.load() == pos )
+				{
+					std::lock_guard<std::mutex> lock( m_drain_mutex );
+					m_event_pushed.notify_one();
+				}
+				return true;
+			}
+		}
+		else if( sequence < pos )
+		{
+			return false;
+		}
+		else
+		{
+			pos = m_push_pos.load( std::memory_order_relaxed );
+		}
+	}
+}
+
+
+bool Async_Add_Observer::try_pop_and_deliver()
+{
+	Slot & slot = mp_slots[m_pop_pos & (m_capacity - 1)];
+
+	if( slot.sequence.load(std::memory_order_acquire) != m_pop_pos + 1 )
+	{
+		return false;
+	}
+
+	try
+	{
+		m_observer.add_occurred( slot.expression, slot.result );
+	}
+	catch( ... )
+	{
+		m_failed_count.fetch_add( 1 );
+	}
+
+	slot.sequence.store( m_pop_pos + m_capacity );
+	++m_pop_pos;
+	m_delivered_count.fetch_add( 1 );
+
+	if( m_waiter_count.load() != 0 )
+	{
+		std::lock_guard<std::mutex> lock( m_waiter_mutex );
+		m_event_delivered.notify_all();
+	}
+
+	return true;
+}
+
+
+bool Async_Add_Observer::has_event_to_deliver() const
+{
+	return mp_slots[m_pop_pos & (m_capacity - 1)].sequence.load() == m_pop_pos + 1;
+}
+
+
+void Async_Add_Observer::drain_loop()
+{
+	while( true )
+	{
+		if( try_pop_and_deliver() )
+		{
+			continue;
+		}
+
+		if( m_stopping.load() )
+		{
+			// Deliver whatever was pushed before the destructor ran.
+			while( try_pop_and_deliver() )
+			{
+			}
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock( m_drain_mutex );
+		m_event_pushed.wait( lock, [this]{ return has_event_to_deliver() || m_stopping.load(); } );
+	}
+}
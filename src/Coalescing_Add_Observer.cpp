@@ -0,0 +1,172 @@
+#include "Coalescing_Add_Observer.h"
+
+#include <utility>
+
+
+Coalescing_Add_Observer::Coalescing_Add_Observer( Batched_Add_Observer_Interface & observer, size_t batch_size, std::chrono::microseconds max_delay ) :
+	m_observer( observer ),
+	m_copy_expressions( observer.needs_expression() ),
+	m_batch_size( (batch_size == 0) ? 1 : batch_size ),
+	m_max_delay( max_delay ),
+	m_delivery_mutex(),
+	m_mutex(),
+	m_first_event_added(),
+	m_pending( m_batch_size ),
+	m_pending_count( 0 ),
+	m_oldest_pending_time(),
+	m_delivering( m_batch_size ),
+	m_batch_count( 0 ),
+	m_failed_count( 0 ),
+	m_stopping( false ),
+	m_timer_thread()
+{
+	if( m_max_delay.count() > 0 )
+	{
+		m_timer_thread = std::thread( &Coalescing_Add_Observer::timer_loop, this );
+	}
+}
+
+
+Coalescing_Add_Observer::~Coalescing_Add_Observer()
+{
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_stopping = true;
+	}
+	m_first_event_added.notify_one();
+
+	if( m_timer_thread.joinable() )
+	{
+		m_timer_thread.join();
+	}
+
+	deliver_pending();
+}
+
+
+void Coalescing_Add_Observer::add_occurred( const std::string & expression, int result )
+{
+	bool batch_is_full = false;
+
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+
+		// Another thread may have filled the batch and not yet taken it.
+		if( m_pending_count == m_pending.size() )
+		{
+			m_pending.emplace_back();
+		}
+
+		// Events reuse the string storage of earlier batches.
+		Add_Event & event = m_pending[m_pending_count];
+		if( m_copy_expressions )
+		{
+			event.expression.assign( expression );
+		}
+		event.result = result;
+
+		if( m_pending_count++ == 0 )
+		{
+			m_oldest_pending_time = std::chrono::steady_clock::now();
+			m_first_event_added.notify_one();
+		}
+
+		batch_is_full = (m_pending_count >= m_batch_size);
+	}
+
+	if( batch_is_full )
+	{
+		deliver_pending();
+	}
+}
+
+
+bool Coalescing_Add_Observer::needs_expression() const
+{
+	return m_copy_expressions;
+}
+
+
+void Coalescing_Add_Observer::flush()
+{
+	deliver_pending();
+}
+
+
+size_t Coalescing_Add_Observer::batch_count() const
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	return m_batch_count;
+}
+
+
+size_t Coalescing_Add_Observer::failed_count() const
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	return m_failed_count;
+}
+
+
+// Batches are taken and delivered under m_delivery_mutex so that they
+// reach the observer in the order they were filled, while other threads
+// carry on adding to the next batch.
+void Coalescing_Add_Observer::deliver_pending()
+{
+	std::lock_guard<std::mutex> delivery_lock( m_delivery_mutex );
+
+	size_t count = 0;
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		if( m_pending_count == 0 )
+		{
+			return;
+		}
+
+		std::swap( m_pending, m_delivering );
+		count = m_pending_count;
+		m_pending_count = 0;
+	}
+
+	bool failed = false;
+	try
+	{
+		m_observer.add_occurred_batch( m_delivering.data(), count );
+	}
+	catch( ... )
+	{
+		failed = true;
+	}
+
+	std::lock_guard<std::mutex> lock( m_mutex );
+	++m_batch_count;
+	if( failed )
+	{
+		++m_failed_count;
+	}
+}
+
+
+void Coalescing_Add_Observer::timer_loop()
+{
+	std::unique_lock<std::mutex> lock( m_mutex );
+
+	while( !m_stopping )
+	{
+		if( m_pending_count == 0 )
+		{
+			m_first_event_added.wait( lock );
+			continue;
+		}
+
+		const auto deadline = m_oldest_pending_time + m_max_delay;
+		if( std::chrono::steady_clock::now() < deadline )
+		{
+			m_first_event_added.wait_until( lock, deadline );
+			continue;
+		}
+
+		lock.unlock();
+		deliver_pending();
+		lock.lock();
+	}
+}
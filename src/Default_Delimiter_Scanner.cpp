@@ -0,0 +1,315 @@
+#include "Default_Delimiter_Scanner.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DEFAULT_DELIMITER_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	uint64_t low_bits( size_t count )
+	{
+		return (count >= 64) ? ~uint64_t(0) : ((uint64_t(1) << count) - 1);
+	}
+
+	unsigned count_trailing_zeros( uint64_t bits )
+	{
+		return static_cast<unsigned>( __builtin_ctzll(bits) );
+	}
+}
+
+
+Default_Delimiter_Scanner::Default_Delimiter_Scanner( Kernel kernel ) :
+	m_kernel( kernel ),
+	m_classify_block( nullptr )
+{
+	if( m_kernel == Kernel::best_available )
+	{
+		m_kernel = is_supported( Kernel::avx2 ) ? Kernel::avx2 :
+		           is_supported( Kernel::sse2 ) ? Kernel::sse2 :
+		                                          Kernel::scalar;
+	}
+	else if( !is_supported(m_kernel) )
+	{
+		m_kernel = Kernel::scalar;
+	}
+
+	m_classify_block = classifier_for( m_kernel );
+}
+
+
+void Default_Delimiter_Scanner::split( std::string_view text, Token_Visitor_Interface & visitor ) const
+{
+	const char * const begin = text.data();
+	const size_t size = text.size();
+
+	size_t token_start = 0;
+	bool token_is_plain_number = true;
+	Number_Batch batch;
+
+	for( size_t block = 0; block < size; block += block_size )
+	{
+		const size_t bytes_in_block = std::min( block_size, size - block );
+		const Block_Masks masks = (bytes_in_block == block_size) ?
+			m_classify_block( begin + block ) :
+			classify_scalar( begin + block, bytes_in_block );
+
+		uint64_t delimiters = masks.delimiters;
+		size_t segment_start = 0;
+
+		while( true )
+		{
+			const size_t segment_end = (delimiters != 0) ? count_trailing_zeros( delimiters ) : bytes_in_block;
+
+			uint64_t suspicious = (masks.others | masks.minus_signs) & low_bits( segment_end ) & ~low_bits( segment_start );
+			if( (segment_start < block_size) && (token_start == block + segment_start) )
+			{
+				// A minus sign is fine as the first character of a token.
+				suspicious &= ~(masks.minus_signs & (uint64_t(1) << segment_start));
+			}
+			if( suspicious != 0 )
+			{
+				token_is_plain_number = false;
+			}
+
+			if( delimiters == 0 )
+			{
+				break;
+			}
+
+			emit_token( text.substr(token_start, block + segment_end - token_start), token_is_plain_number, batch, visitor );
+
+			token_start = block + segment_end + 1;
+			token_is_plain_number = true;
+			segment_start = segment_end + 1;
+			delimiters &= delimiters - 1;
+		}
+	}
+
+	if( token_start < size )
+	{
+		emit_token( text.substr(token_start), token_is_plain_number, batch, visitor );
+	}
+
+	flush_numbers( batch, visitor );
+}
+
+
+Default_Delimiter_Scanner::Kernel Default_Delimiter_Scanner::kernel() const
+{
+	return m_kernel;
+}
+
+
+bool Default_Delimiter_Scanner::is_supported( Kernel kernel )
+{
+	switch( kernel )
+	{
+		case Kernel::scalar:
+		case Kernel::best_available:
+			return true;
+#if DEFAULT_DELIMITER_SCANNER_X86
+		case Kernel::sse2:
+			return __builtin_cpu_supports( "sse2" );
+		case Kernel::avx2:
+			return __builtin_cpu_supports( "avx2" );
+#endif
+		default:
+			return false;
+	}
+}
+
+
+Default_Delimiter_Scanner::Block_Masks Default_Delimiter_Scanner::classify_scalar( const char * block, size_t size )
+{
+	Block_Masks masks { 0, 0, 0 };
+
+	for( size_t i = 0; i < size; ++i )
+	{
+		const uint64_t bit = uint64_t(1) << i;
+		const char c = block[i];
+
+		if( (c == ',') || (c == '\n') )
+		{
+			masks.delimiters |= bit;
+		}
+		else if( c == '-' )
+		{
+			masks.minus_signs |= bit;
+		}
+		else if( (c < '0') || (c > '9') )
+		{
+			masks.others |= bit;
+		}
+	}
+
+	return masks;
+}
+
+
+Default_Delimiter_Scanner::Block_Masks Default_Delimiter_Scanner::classify_scalar_block( const char * block )
+{
+	return classify_scalar( block, block_size );
+}
+
+
+#if DEFAULT_DELIMITER_SCANNER_X86
+
+__attribute__((target("sse2")))
+Default_Delimiter_Scanner::Block_Masks Default_Delimiter_Scanner::classify_sse2_block( const char * block )
+{
+	const __m128i comma = _mm_set1_epi8( ',' );
+	const __m128i newline = _mm_set1_epi8( '\n' );
+	const __m128i minus = _mm_set1_epi8( '-' );
+	const __m128i zero = _mm_set1_epi8( '0' );
+	const __m128i nine = _mm_set1_epi8( 9 );
+
+	Block_Masks masks { 0, 0, 0 };
+
+	for( size_t lane = 0; lane < block_size; lane += 16 )
+	{
+		const __m128i bytes = _mm_loadu_si128( reinterpret_cast<const __m128i *>(block + lane) );
+		const __m128i offsets = _mm_sub_epi8( bytes, zero );
+		const __m128i is_digit = _mm_cmpeq_epi8( _mm_min_epu8(offsets, nine), offsets );
+		const __m128i is_delimiter = _mm_or_si128( _mm_cmpeq_epi8(bytes, comma), _mm_cmpeq_epi8(bytes, newline) );
+		const __m128i is_minus = _mm_cmpeq_epi8( bytes, minus );
+		const __m128i is_known = _mm_or_si128( _mm_or_si128(is_digit, is_delimiter), is_minus );
+
+		masks.delimiters |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(is_delimiter))) << lane;
+		masks.minus_signs |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(is_minus))) << lane;
+		masks.others |= uint64_t(static_cast<uint16_t>(~_mm_movemask_epi8(is_known))) << lane;
+	}
+
+	return masks;
+}
+
+
+__attribute__((target("avx2")))
+Default_Delimiter_Scanner::Block_Masks Default_Delimiter_Scanner::classify_avx2_block( const char * block )
+{
+	const __m256i comma = _mm256_set1_epi8( ',' );
+	const __m256i newline = _mm256_set1_epi8( '\n' );
+	const __m256i minus = _mm256_set1_epi8( '-' );
+	const __m256i zero = _mm256_set1_epi8( '0' );
+	const __m256i nine = _mm256_set1_epi8( 9 );
+
+	Block_Masks masks { 0, 0, 0 };
+
+	for( size_t lane = 0; lane < block_size; lane += 32 )
+	{
+		const __m256i bytes = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(block + lane) );
+		const __m256i offsets = _mm256_sub_epi8( bytes, zero );
+		const __m256i is_digit = _mm256_cmpeq_epi8( _mm256_min_epu8(offsets, nine), offsets );
+		const __m256i is_delimiter = _mm256_or_si256( _mm256_cmpeq_epi8(bytes, comma), _mm256_cmpeq_epi8(bytes, newline) );
+		const __m256i is_minus = _mm256_cmpeq_epi8( bytes, minus );
+		const __m256i is_known = _mm256_or_si256( _mm256_or_si256(is_digit, is_delimiter), is_minus );
+
+		masks.delimiters |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(is_delimiter))) << lane;
+		masks.minus_signs |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(is_minus))) << lane;
+		masks.others |= uint64_t(static_cast<uint32_t>(~_mm256_movemask_epi8(is_known))) << lane;
+	}
+
+	return masks;
+}
+
+#else
+
+Default_Delimiter_Scanner::Block_Masks Default_Delimiter_Scanner::classify_sse2_block( const char * block )
+{
+	return classify_scalar_block( block );
+}
+
+
+Default_Delimiter_Scanner::Block_Masks Default_Delimiter_Scanner::classify_avx2_block( const char * block )
+{
+	return classify_scalar_block( block );
+}
+
+#endif
+
+
+Default_Delimiter_Scanner::Block_Classifier Default_Delimiter_Scanner::classifier_for( Kernel kernel )
+{
+	switch( kernel )
+	{
+		case Kernel::avx2:
+			return &classify_avx2_block;
+		case Kernel::sse2:
+			return &classify_sse2_block;
+		default:
+			return &classify_scalar_block;
+	}
+}
+
+
+// Numbers wait in the batch until it fills or another kind of token comes
+// along, so the visitor still sees every token in order.
+void Default_Delimiter_Scanner::emit_token( std::string_view token, bool is_plain_number, Number_Batch & batch, Token_Visitor_Interface & visitor ) const
+{
+	if( token.empty() )
+	{
+		return;
+	}
+
+	if( is_plain_number )
+	{
+		const bool is_negative = (token.front() == '-');
+		const size_t digit_count = token.size() - (is_negative ? 1 : 0);
+
+		if( (digit_count > 0) && (digit_count <= 8) )
+		{
+			const int magnitude = parse_digits( token.data() + (is_negative ? 1 : 0), digit_count );
+			batch.tokens[batch.count] = token;
+			batch.numbers[batch.count] = is_negative ? -magnitude : magnitude;
+
+			if( ++batch.count == batch_capacity )
+			{
+				flush_numbers( batch, visitor );
+			}
+			return;
+		}
+	}
+
+	flush_numbers( batch, visitor );
+	visitor.token_found( token );
+}
+
+
+void Default_Delimiter_Scanner::flush_numbers( Number_Batch & batch, Token_Visitor_Interface & visitor )
+{
+	if( batch.count != 0 )
+	{
+		visitor.numbers_found( batch.tokens, batch.numbers, batch.count );
+		batch.count = 0;
+	}
+}
+
+
+int Default_Delimiter_Scanner::parse_digits( const char * digits, size_t count ) const
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+	// Right-align the digits in a word of '0's, then combine neighbouring
+	// digits, pairs and quads with three multiply-adds.
+	uint64_t word = 0x3030303030303030ull;
+	std::memcpy( reinterpret_cast<char *>(&word) + (8 - count), digits, count );
+
+	word -= 0x3030303030303030ull;
+	word = (word * 10) + (word >> 8);
+	word = (((word & 0x000000FF000000FFull) * 0x000F424000000064ull) +
+	        (((word >> 16) & 0x000000FF000000FFull) * 0x0000271000000001ull)) >> 32;
+
+	return static_cast<int>( word );
+#else
+	int value = 0;
+
+	for( size_t i = 0; i < count; ++i )
+	{
+		value = (value * 10) + (digits[i] - '0');
+	}
+
+	return value;
+#endif
+}
@@ -0,0 +1,79 @@
+#include "Delimiter_Header_Cache.h"
+
+
+Delimiter_Header_Cache::Delimiter_Header_Cache( size_t capacity ) :
+	m_capacity( capacity ),
+	m_mutex(),
+	m_entries(),
+	m_index(),
+	m_hit_count( 0 ),
+	m_miss_count( 0 )
+{
+}
+
+
+std::shared_ptr<const Delimiter_Header_Cache::Compiled_Header> Delimiter_Header_Cache::find_or_compile( std::string_view header, const Compiler & compile )
+{
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+
+		const auto found = m_index.find( header );
+		if( found != m_index.end() )
+		{
+			++m_hit_count;
+			m_entries.splice( m_entries.begin(), m_entries, found->second );
+			return found->second->compiled;
+		}
+
+		++m_miss_count;
+	}
+
+	// Compile without holding the lock.  Another thread may compile the
+	// same header meanwhile, in which case the first one in is kept.
+	std::shared_ptr<const Compiled_Header> compiled( compile(header) );
+
+	std::lock_guard<std::mutex> lock( m_mutex );
+
+	if( (m_capacity == 0) || (m_index.count(header) != 0) )
+	{
+		return compiled;
+	}
+
+	if( m_entries.size() == m_capacity )
+	{
+		m_index.erase( m_entries.back().header );
+		m_entries.pop_back();
+	}
+
+	m_entries.push_front( Entry{ std::string(header), compiled } );
+	m_index.emplace( m_entries.front().header, m_entries.begin() );
+
+	return compiled;
+}
+
+
+size_t Delimiter_Header_Cache::hit_count() const
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	return m_hit_count;
+}
+
+
+size_t Delimiter_Header_Cache::miss_count() const
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	return m_miss_count;
+}
+
+
+size_t Delimiter_Header_Cache::size() const
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	return m_entries.size();
+}
+
+
+size_t Delimiter_Header_Cache::capacity() const
+{
+	return m_capacity;
+}
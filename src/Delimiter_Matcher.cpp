@@ -0,0 +1,296 @@
+#include "Delimiter_Matcher.h"
+
+#include <algorithm>
+#include <map>
+
+
+Delimiter_Matcher::Delimiter_Matcher( const std::set<std::string> & delimiters ) :
+	m_root(),
+	m_is_delimiter_byte(),
+	m_nodes(),
+	m_edges(),
+	m_longest_delimiter_size( 0 ),
+	m_is_single_pass( matches_never_overlap(delimiters) ),
+	m_longest_first()
+{
+	// Build a node-per-prefix trie first, then flatten it so that the
+	// children of every node sit next to each other in m_edges.
+	std::vector<std::map<unsigned char, uint32_t>> children( 1 );
+	std::vector<uint32_t> match_sizes( 1, 0 );
+	m_is_delimiter_byte.fill( false );
+
+	for( const std::string & delimiter : delimiters )
+	{
+		uint32_t node = 0;
+
+		for( char c : delimiter )
+		{
+			const unsigned char byte = static_cast<unsigned char>( c );
+			m_is_delimiter_byte[byte] = true;
+			auto child = children[node].find( byte );
+
+			if( child == children[node].end() )
+			{
+				const uint32_t new_node = static_cast<uint32_t>( children.size() );
+				children[node][byte] = new_node;
+				children.emplace_back();
+				match_sizes.push_back( 0 );
+				node = new_node;
+			}
+			else
+			{
+				node = child->second;
+			}
+		}
+
+		match_sizes[node] = static_cast<uint32_t>( delimiter.size() );
+		m_longest_delimiter_size = std::max( m_longest_delimiter_size, delimiter.size() );
+	}
+
+	m_root.fill( no_node );
+	for( const auto & [byte, child] : children[0] )
+	{
+		m_root[byte] = child;
+	}
+
+	// Equal lengths keep the set's order, as the original stable sort did.
+	if( !m_is_single_pass )
+	{
+		m_longest_first.assign( delimiters.begin(), delimiters.end() );
+		std::stable_sort( m_longest_first.begin(), m_longest_first.end(),
+		                  []( const std::string & a, const std::string & b ) { return a.size() > b.size(); } );
+	}
+
+	m_nodes.reserve( children.size() );
+	for( size_t node = 0; node < children.size(); ++node )
+	{
+		m_nodes.push_back( Node{ static_cast<uint32_t>(m_edges.size()),
+		                         static_cast<uint32_t>(children[node].size()),
+		                         match_sizes[node] } );
+
+		for( const auto & [byte, child] : children[node] )
+		{
+			m_edges.push_back( Edge{ byte, child } );
+		}
+	}
+}
+
+
+size_t Delimiter_Matcher::match( std::string_view text, size_t pos ) const
+{
+	uint32_t node = m_root[static_cast<unsigned char>(text[pos])];
+	size_t longest_match = 0;
+
+	while( node != no_node )
+	{
+		longest_match = std::max<size_t>( longest_match, m_nodes[node].match_size );
+
+		if( ++pos == text.size() )
+		{
+			break;
+		}
+
+		node = find_child( node, static_cast<unsigned char>(text[pos]) );
+	}
+
+	return longest_match;
+}
+
+
+void Delimiter_Matcher::split( std::string_view text, Token_Visitor_Interface & visitor ) const
+{
+	if( !m_is_single_pass )
+	{
+		split_longest_first( text, visitor );
+		return;
+	}
+
+	size_t token_start = 0;
+	size_t pos = 0;
+
+	while( pos < text.size() )
+	{
+		const size_t delimiter_size = match( text, pos );
+
+		if( delimiter_size > 0 )
+		{
+			if( pos > token_start )
+			{
+				visitor.token_found( text.substr(token_start, pos - token_start) );
+			}
+
+			pos += delimiter_size;
+			token_start = pos;
+		}
+		else
+		{
+			++pos;
+		}
+	}
+
+	if( pos > token_start )
+	{
+		visitor.token_found( text.substr(token_start, pos - token_start) );
+	}
+}
+
+
+size_t Delimiter_Matcher::next_safe_cut( std::string_view text, size_t pos ) const
+{
+	if( !m_is_single_pass )
+	{
+		return text.size();
+	}
+
+	for( pos = std::max<size_t>( pos, 1 ); pos < text.size(); ++pos )
+	{
+		if( is_safe_cut(text, pos) )
+		{
+			return pos;
+		}
+	}
+
+	return text.size();
+}
+
+
+size_t Delimiter_Matcher::previous_safe_cut( std::string_view text, size_t pos ) const
+{
+	if( text.empty() || !m_is_single_pass )
+	{
+		return 0;
+	}
+
+	for( pos = std::min( pos, text.size() - 1 ); pos > 0; --pos )
+	{
+		if( is_safe_cut(text, pos) )
+		{
+			return pos;
+		}
+	}
+
+	return 0;
+}
+
+
+size_t Delimiter_Matcher::longest_delimiter_size() const
+{
+	return m_longest_delimiter_size;
+}
+
+
+bool Delimiter_Matcher::is_single_pass() const
+{
+	return m_is_single_pass;
+}
+
+
+bool Delimiter_Matcher::is_safe_cut( std::string_view text, size_t pos ) const
+{
+	return !m_is_delimiter_byte[static_cast<unsigned char>(text[pos - 1])] && (match(text, pos) > 0);
+}
+
+
+// Each delimiter in turn, longest first, is replaced everywhere by a
+// comma, which may complete or break matches of the delimiters after it.
+// Every byte of the working copy remembers where it came from, so that the
+// tokens can still be handed on as views of text.
+void Delimiter_Matcher::split_longest_first( std::string_view text, Token_Visitor_Interface & visitor ) const
+{
+	std::string buffer( text );
+	std::vector<size_t> origins( text.size() );
+	for( size_t i = 0; i < origins.size(); ++i )
+	{
+		origins[i] = i;
+	}
+
+	std::string replaced;
+	std::vector<size_t> replaced_origins;
+
+	for( const std::string & delimiter : m_longest_first )
+	{
+		replaced.clear();
+		replaced_origins.clear();
+
+		size_t copied = 0;
+		for( size_t pos = buffer.find( delimiter ); pos != std::string::npos; pos = buffer.find( delimiter, copied ) )
+		{
+			replaced.append( buffer, copied, pos - copied );
+			replaced_origins.insert( replaced_origins.end(), origins.begin() + copied, origins.begin() + pos );
+			replaced += ',';
+			replaced_origins.push_back( origins[pos] );
+			copied = pos + delimiter.size();
+		}
+
+		replaced.append( buffer, copied, std::string::npos );
+		replaced_origins.insert( replaced_origins.end(), origins.begin() + copied, origins.end() );
+
+		buffer.swap( replaced );
+		origins.swap( replaced_origins );
+	}
+
+	// Bytes other than commas were never replaced, so a run of them is a
+	// run of text.
+	size_t token_start = 0;
+	while( token_start < buffer.size() )
+	{
+		const size_t token_end = std::min( buffer.find( ',', token_start ), buffer.size() );
+
+		if( token_end > token_start )
+		{
+			visitor.token_found( text.substr(origins[token_start], token_end - token_start) );
+		}
+
+		token_start = token_end + 1;
+	}
+}
+
+
+// Leftmost-longest and longest-first can only disagree where matches of two
+// different delimiters overlap, or where a comma left by one replacement
+// completes a match.  A delimiter overlapping itself is matched left to
+// right without overlaps either way.
+bool Delimiter_Matcher::matches_never_overlap( const std::set<std::string> & delimiters )
+{
+	for( const std::string & a : delimiters )
+	{
+		if( (a != ",") && (a.find(',') != std::string::npos) )
+		{
+			return false;
+		}
+
+		for( const std::string & b : delimiters )
+		{
+			if( a == b )
+			{
+				continue;
+			}
+
+			for( size_t size = 1; (size < a.size()) && (size < b.size()); ++size )
+			{
+				if( a.compare(a.size() - size, size, b, 0, size) == 0 )
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+
+uint32_t Delimiter_Matcher::find_child( uint32_t node, unsigned char byte ) const
+{
+	const Node & parent = m_nodes[node];
+
+	for( uint32_t edge = parent.first_edge; edge < parent.first_edge + parent.edge_count; ++edge )
+	{
+		if( m_edges[edge].byte == byte )
+		{
+			return m_edges[edge].child;
+		}
+	}
+
+	return no_node;
+}
@@ -0,0 +1,75 @@
+#include "Dispatching_Tokenizer.h"
+
+namespace
+{
+	class Token_Collector : public Token_Visitor_Interface
+	{
+		public:
+
+			void token_found( std::string_view token ) override
+			{
+				tokens.emplace_back( token );
+			}
+
+			std::vector<std::string> tokens;
+	};
+}
+
+
+Dispatching_Tokenizer::Dispatching_Tokenizer() :
+	m_formats(),
+	m_generic_tokenizer()
+{
+}
+
+
+std::vector<std::string> Dispatching_Tokenizer::parse_tokens( const std::string & expression ) const
+{
+	Token_Collector collector;
+	visit_tokens( expression, collector );
+	return collector.tokens;
+}
+
+
+void Dispatching_Tokenizer::visit_tokens( std::string_view expression, Token_Visitor_Interface & visitor ) const
+{
+	const size_t header_size = m_generic_tokenizer.delimiter_header_size( expression );
+	const std::string_view header( expression.substr(0, header_size) );
+
+	// Only a handful of formats are ever registered, so a linear search
+	// beats hashing the header.
+	for( const auto & [registered_header, split] : m_formats )
+	{
+		if( registered_header == header )
+		{
+			split( expression.substr(header_size), visitor );
+			return;
+		}
+	}
+
+	m_generic_tokenizer.visit_tokens( expression, visitor );
+}
+
+
+void Dispatching_Tokenizer::visit_body_tokens( std::string_view body, const Expression_Format & format, Token_Visitor_Interface & visitor ) const
+{
+	m_generic_tokenizer.visit_body_tokens( body, format, visitor );
+}
+
+
+void Dispatching_Tokenizer::visit_source_tokens( Byte_Source_Interface & source, Token_Visitor_Interface & visitor ) const
+{
+	m_generic_tokenizer.visit_source_tokens( source, visitor );
+}
+
+
+std::unique_ptr<Chunked_Expression_Interface> Dispatching_Tokenizer::cut_into_chunks( std::string_view expression, size_t max_chunks ) const
+{
+	return m_generic_tokenizer.cut_into_chunks( expression, max_chunks );
+}
+
+
+const Tokenizer & Dispatching_Tokenizer::generic_tokenizer() const
+{
+	return m_generic_tokenizer;
+}
@@ -0,0 +1,55 @@
+#include "Expression_Format.h"
+
+#include <utility>
+
+namespace
+{
+	std::shared_ptr<const Expression_Format::Compiled_Header> compile( const std::set<std::string> & delimiters )
+	{
+		return std::make_shared<const Expression_Format::Compiled_Header>(
+			Expression_Format::Compiled_Header{ Delimiter_Matcher(delimiters), delimiters == Expression_Format::default_delimiters() } );
+	}
+}
+
+
+Expression_Format::Expression_Format() :
+	mp_compiled()
+{
+	static const std::shared_ptr<const Compiled_Header> p_default_compiled( compile(default_delimiters()) );
+	mp_compiled = p_default_compiled;
+}
+
+
+Expression_Format::Expression_Format( std::shared_ptr<const Compiled_Header> p_compiled ) :
+	mp_compiled( std::move(p_compiled) )
+{
+}
+
+
+Expression_Format Expression_Format::from_delimiters( const std::set<std::string> & delimiters )
+{
+	std::set<std::string> all_delimiters( default_delimiters() );
+	all_delimiters.insert( delimiters.begin(), delimiters.end() );
+	all_delimiters.erase( std::string() );
+
+	return Expression_Format( compile(all_delimiters) );
+}
+
+
+const std::set<std::string> & Expression_Format::default_delimiters()
+{
+	static const std::set<std::string> delimiters {",", "\n"};
+	return delimiters;
+}
+
+
+const Delimiter_Matcher & Expression_Format::matcher() const
+{
+	return mp_compiled->matcher;
+}
+
+
+bool Expression_Format::is_default_format() const
+{
+	return mp_compiled->is_default_format;
+}
@@ -0,0 +1,31 @@
+#include "Fd_Byte_Source.h"
+
+#include <cerrno>
+#include <system_error>
+
+#include <unistd.h>
+
+
+Fd_Byte_Source::Fd_Byte_Source( int fd ) :
+	m_fd( fd )
+{
+}
+
+
+size_t Fd_Byte_Source::read( char * buffer, size_t size )
+{
+	while( true )
+	{
+		const ssize_t bytes_read = ::read( m_fd, buffer, size );
+
+		if( bytes_read >= 0 )
+		{
+			return static_cast<size_t>( bytes_read );
+		}
+
+		if( errno != EINTR )
+		{
+			throw std::system_error( errno, std::generic_category(), "read" );
+		}
+	}
+}
@@ -0,0 +1,181 @@
+#include "Filter_Sum_Kernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FILTER_SUM_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+
+Filter_Sum_Kernel::Filter_Sum_Kernel( Kernel kernel ) :
+	m_kernel( kernel ),
+	m_filter_sum( nullptr )
+{
+	if( m_kernel == Kernel::best_available )
+	{
+		m_kernel = is_supported( Kernel::avx2 ) ? Kernel::avx2 :
+		           is_supported( Kernel::sse2 ) ? Kernel::sse2 :
+		                                          Kernel::scalar;
+	}
+	else if( !is_supported(m_kernel) )
+	{
+		m_kernel = Kernel::scalar;
+	}
+
+	m_filter_sum = function_for( m_kernel );
+}
+
+
+Filter_Sum_Kernel::Result Filter_Sum_Kernel::filter_sum( const int * numbers, size_t count, int max_number ) const
+{
+	return m_filter_sum( numbers, count, max_number );
+}
+
+
+Filter_Sum_Kernel::Kernel Filter_Sum_Kernel::kernel() const
+{
+	return m_kernel;
+}
+
+
+bool Filter_Sum_Kernel::is_supported( Kernel kernel )
+{
+	switch( kernel )
+	{
+		case Kernel::scalar:
+		case Kernel::best_available:
+			return true;
+#if FILTER_SUM_KERNEL_X86
+		case Kernel::sse2:
+			return __builtin_cpu_supports( "sse2" );
+		case Kernel::avx2:
+			return __builtin_cpu_supports( "avx2" );
+#endif
+		default:
+			return false;
+	}
+}
+
+
+const Filter_Sum_Kernel & Filter_Sum_Kernel::best_available()
+{
+	static const Filter_Sum_Kernel kernel;
+	return kernel;
+}
+
+
+// Seen as unsigned, a negative number is larger than any limit, so one
+// comparison leaves out both kinds of number.  A negative limit would be
+// larger still, so it is masked out up front to leave out everything, as
+// the vector kernels' signed comparisons do.
+Filter_Sum_Kernel::Result Filter_Sum_Kernel::filter_sum_scalar( const int * numbers, size_t count, int max_number )
+{
+	const uint32_t limit = static_cast<uint32_t>( max_number );
+	const uint32_t limit_mask = -static_cast<uint32_t>( max_number >= 0 );
+
+	int64_t total = 0;
+	uint32_t negative_bits = 0;
+
+	for( size_t i = 0; i < count; ++i )
+	{
+		const uint32_t number = static_cast<uint32_t>( numbers[i] );
+		const uint32_t keep_mask = -static_cast<uint32_t>( number <= limit ) & limit_mask;
+
+		total += number & keep_mask;
+		negative_bits |= number;
+	}
+
+	return Result{ total, (negative_bits >> 31) != 0 };
+}
+
+
+#if FILTER_SUM_KERNEL_X86
+
+// The numbers that are kept are never negative, so they are widened by
+// interleaving them with zeros.
+__attribute__((target("sse2")))
+Filter_Sum_Kernel::Result Filter_Sum_Kernel::filter_sum_sse2( const int * numbers, size_t count, int max_number )
+{
+	const __m128i limit = _mm_set1_epi32( max_number );
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i totals = _mm_setzero_si128();
+	__m128i negatives = _mm_setzero_si128();
+
+	size_t i = 0;
+	for( ; i + 4 <= count; i += 4 )
+	{
+		const __m128i values = _mm_loadu_si128( reinterpret_cast<const __m128i *>(numbers + i) );
+		const __m128i is_negative = _mm_cmplt_epi32( values, zero );
+		const __m128i is_left_out = _mm_or_si128( _mm_cmpgt_epi32(values, limit), is_negative );
+		const __m128i kept = _mm_andnot_si128( is_left_out, values );
+
+		totals = _mm_add_epi64( totals, _mm_unpacklo_epi32(kept, zero) );
+		totals = _mm_add_epi64( totals, _mm_unpackhi_epi32(kept, zero) );
+		negatives = _mm_or_si128( negatives, is_negative );
+	}
+
+	int64_t lanes[2];
+	_mm_storeu_si128( reinterpret_cast<__m128i *>(lanes), totals );
+
+	const Result tail = filter_sum_scalar( numbers + i, count - i, max_number );
+	return Result{ lanes[0] + lanes[1] + tail.total, (_mm_movemask_epi8(negatives) != 0) || tail.has_negative_numbers };
+}
+
+
+__attribute__((target("avx2")))
+Filter_Sum_Kernel::Result Filter_Sum_Kernel::filter_sum_avx2( const int * numbers, size_t count, int max_number )
+{
+	const __m256i limit = _mm256_set1_epi32( max_number );
+	const __m256i zero = _mm256_setzero_si256();
+
+	__m256i totals = _mm256_setzero_si256();
+	__m256i negatives = _mm256_setzero_si256();
+
+	size_t i = 0;
+	for( ; i + 8 <= count; i += 8 )
+	{
+		const __m256i values = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(numbers + i) );
+		const __m256i is_negative = _mm256_cmpgt_epi32( zero, values );
+		const __m256i is_left_out = _mm256_or_si256( _mm256_cmpgt_epi32(values, limit), is_negative );
+		const __m256i kept = _mm256_andnot_si256( is_left_out, values );
+
+		totals = _mm256_add_epi64( totals, _mm256_unpacklo_epi32(kept, zero) );
+		totals = _mm256_add_epi64( totals, _mm256_unpackhi_epi32(kept, zero) );
+		negatives = _mm256_or_si256( negatives, is_negative );
+	}
+
+	int64_t lanes[4];
+	_mm256_storeu_si256( reinterpret_cast<__m256i *>(lanes), totals );
+
+	const Result tail = filter_sum_scalar( numbers + i, count - i, max_number );
+	return Result{ lanes[0] + lanes[1] + lanes[2] + lanes[3] + tail.total, (_mm256_movemask_epi8(negatives) != 0) || tail.has_negative_numbers };
+}
+
+#else
+
+Filter_Sum_Kernel::Result Filter_Sum_Kernel::filter_sum_sse2( const int * numbers, size_t count, int max_number )
+{
+	return filter_sum_scalar( numbers, count, max_number );
+}
+
+
+Filter_Sum_Kernel::Result Filter_Sum_Kernel::filter_sum_avx2( const int * numbers, size_t count, int max_number )
+{
+	return filter_sum_scalar( numbers, count, max_number );
+}
+
+#endif
+
+
+Filter_Sum_Kernel::Function Filter_Sum_Kernel::function_for( Kernel kernel )
+{
+	switch( kernel )
+	{
+		case Kernel::avx2:
+			return &filter_sum_avx2;
+		case Kernel::sse2:
+			return &filter_sum_sse2;
+		default:
+			return &filter_sum_scalar;
+	}
+}
@@ -0,0 +1,22 @@
+#include "Istream_Byte_Source.h"
+
+#include <stdexcept>
+
+
+Istream_Byte_Source::Istream_Byte_Source( std::istream & input ) :
+	m_input( input )
+{
+}
+
+
+size_t Istream_Byte_Source::read( char * buffer, size_t size )
+{
+	m_input.read( buffer, static_cast<std::streamsize>(size) );
+
+	if( m_input.bad() )
+	{
+		throw std::runtime_error( "read failed" );
+	}
+
+	return static_cast<size_t>( m_input.gcount() );
+}
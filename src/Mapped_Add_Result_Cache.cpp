@@ -0,0 +1,369 @@
+#include "Mapped_Add_Result_Cache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+// The checksum covers everything before it.
+struct Mapped_Add_Result_Cache::File_Header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t slot_size;
+	uint64_t bucket_count;
+	uint64_t slots_per_bucket;
+	uint64_t checksum;
+	uint8_t reserved[24];
+};
+
+
+// The checksum covers everything after it, up to the end of the expression
+// and message bytes in the payload.
+struct Mapped_Add_Result_Cache::Slot
+{
+	static const uint32_t occupied = 1;
+	static const uint32_t has_negative_numbers = 2;
+	static const size_t payload_size = slot_size - 40;
+
+	uint64_t checksum;
+	uint64_t hash;
+	int64_t total;
+	uint32_t expression_size;
+	uint32_t message_size;
+	uint32_t flags;
+	uint32_t reserved;
+	char payload[payload_size];
+};
+
+
+namespace
+{
+	const char file_magic[8] = { 'S', 'C', 'R', 'C', 'A', 'C', 'H', 'E' };
+
+	std::system_error system_error( const std::string & what )
+	{
+		return std::system_error( errno, std::generic_category(), what );
+	}
+
+	// 64-bit FNV-1a, which unlike std::hash is the same in every build, so
+	// it can be used for hashes kept in the file.
+	uint64_t fnv1a( const void * p_data, size_t size, uint64_t hash = 14695981039346656037ull )
+	{
+		const unsigned char * const p_bytes = static_cast<const unsigned char *>( p_data );
+
+		for( size_t i = 0; i < size; ++i )
+		{
+			hash = (hash ^ p_bytes[i]) * 1099511628211ull;
+		}
+
+		return hash;
+	}
+}
+
+
+Mapped_Add_Result_Cache::Mapped_Add_Result_Cache( const std::string & path, size_t capacity ) :
+	m_path( path ),
+	m_bucket_count( std::max<size_t>(1, (capacity + slots_per_bucket - 1) / slots_per_bucket) ),
+	m_fd( -1 ),
+	mp_data( nullptr ),
+	m_size( sizeof(File_Header) + m_bucket_count * slots_per_bucket * sizeof(Slot) ),
+	m_opened_existing( false ),
+	mp_locks( new std::mutex[lock_count] ),
+	m_referenced( m_bucket_count * slots_per_bucket, 0 ),
+	m_clock_hands( m_bucket_count, 0 ),
+	m_hit_count( 0 ),
+	m_miss_count( 0 ),
+	m_corrupt_slot_count( 0 )
+{
+	static_assert( sizeof(File_Header) == 64, "the file header layout is part of the format" );
+	static_assert( sizeof(Slot) == slot_size, "the slot layout is part of the format" );
+
+	m_fd = ::open( path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644 );
+	if( m_fd < 0 )
+	{
+		throw system_error( "open " + path );
+	}
+
+	try
+	{
+		if( ::flock(m_fd, LOCK_EX | LOCK_NB) != 0 )
+		{
+			throw system_error( "flock " + path );
+		}
+
+		struct stat status;
+		if( ::fstat(m_fd, &status) != 0 )
+		{
+			throw system_error( "fstat " + path );
+		}
+
+		m_opened_existing = (static_cast<size_t>(status.st_size) == m_size) && map_existing();
+
+		if( !m_opened_existing )
+		{
+			map_new();
+		}
+	}
+	catch( ... )
+	{
+		::close( m_fd );
+		throw;
+	}
+}
+
+
+Mapped_Add_Result_Cache::~Mapped_Add_Result_Cache()
+{
+	::munmap( mp_data, m_size );
+	::close( m_fd );
+}
+
+
+bool Mapped_Add_Result_Cache::find( std::string_view expression, Entry & entry )
+{
+	if( expression.size() > Slot::payload_size )
+	{
+		return false;
+	}
+
+	const uint64_t hash = fnv1a( expression.data(), expression.size() );
+	const size_t bucket = hash % m_bucket_count;
+	std::lock_guard<std::mutex> lock( lock_for(bucket) );
+
+	Slot * const p_slot = find_slot( bucket, hash, expression );
+	if( p_slot == nullptr )
+	{
+		++m_miss_count;
+		return false;
+	}
+
+	++m_hit_count;
+	m_referenced[p_slot - &slot(0)] = 1;
+
+	entry.has_negative_numbers = (p_slot->flags & Slot::has_negative_numbers) != 0;
+	entry.total = p_slot->total;
+	entry.negative_numbers_message.assign( p_slot->payload + p_slot->expression_size, p_slot->message_size );
+	return true;
+}
+
+
+void Mapped_Add_Result_Cache::store_total( std::string_view expression, int64_t total )
+{
+	store( expression, false, total, std::string_view() );
+}
+
+
+void Mapped_Add_Result_Cache::store_negative_numbers( std::string_view expression, const std::string & message )
+{
+	store( expression, true, 0, message );
+}
+
+
+size_t Mapped_Add_Result_Cache::max_expression_size() const
+{
+	return Slot::payload_size;
+}
+
+
+void Mapped_Add_Result_Cache::flush()
+{
+	if( ::msync(mp_data, m_size, MS_SYNC) != 0 )
+	{
+		throw system_error( "msync " + m_path );
+	}
+}
+
+
+bool Mapped_Add_Result_Cache::opened_existing() const
+{
+	return m_opened_existing;
+}
+
+
+size_t Mapped_Add_Result_Cache::hit_count() const
+{
+	return m_hit_count.load();
+}
+
+
+size_t Mapped_Add_Result_Cache::miss_count() const
+{
+	return m_miss_count.load();
+}
+
+
+size_t Mapped_Add_Result_Cache::corrupt_slot_count() const
+{
+	return m_corrupt_slot_count.load();
+}
+
+
+size_t Mapped_Add_Result_Cache::capacity() const
+{
+	return m_bucket_count * slots_per_bucket;
+}
+
+
+// The checksum is written last, so a slot left half written by a crash
+// fails its check and is treated as empty.
+void Mapped_Add_Result_Cache::store( std::string_view expression, bool has_negative_numbers, int64_t total, std::string_view message )
+{
+	if( expression.size() + message.size() > Slot::payload_size )
+	{
+		return;
+	}
+
+	const uint64_t hash = fnv1a( expression.data(), expression.size() );
+	const size_t bucket = hash % m_bucket_count;
+	std::lock_guard<std::mutex> lock( lock_for(bucket) );
+
+	Slot * p_slot = find_slot( bucket, hash, expression );
+	if( p_slot == nullptr )
+	{
+		p_slot = &slot( victim(bucket) );
+	}
+
+	Slot & s = *p_slot;
+	s.hash = hash;
+	s.expression_size = static_cast<uint32_t>( expression.size() );
+	s.message_size = static_cast<uint32_t>( message.size() );
+	s.total = total;
+	s.flags = Slot::occupied | (has_negative_numbers ? Slot::has_negative_numbers : 0);
+	s.reserved = 0;
+	std::memcpy( s.payload, expression.data(), expression.size() );
+	std::memcpy( s.payload + expression.size(), message.data(), message.size() );
+	s.checksum = fnv1a( &s.hash, offsetof(Slot, payload) - offsetof(Slot, hash) + expression.size() + message.size() );
+
+	m_referenced[p_slot - &slot(0)] = 0;
+}
+
+
+bool Mapped_Add_Result_Cache::map_existing()
+{
+	mp_data = ::mmap( nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0 );
+	if( mp_data == MAP_FAILED )
+	{
+		throw system_error( "mmap " + m_path );
+	}
+
+	const File_Header & header = *static_cast<const File_Header *>( mp_data );
+
+	const bool is_usable =
+		(std::memcmp(header.magic, file_magic, sizeof(file_magic)) == 0) &&
+		(header.version == format_version) &&
+		(header.slot_size == slot_size) &&
+		(header.bucket_count == m_bucket_count) &&
+		(header.slots_per_bucket == slots_per_bucket) &&
+		(header.checksum == fnv1a(&header, offsetof(File_Header, checksum)));
+
+	if( !is_usable )
+	{
+		::munmap( mp_data, m_size );
+		mp_data = nullptr;
+	}
+
+	return is_usable;
+}
+
+
+void Mapped_Add_Result_Cache::map_new()
+{
+	// Truncating to nothing first leaves every slot zeroed, and so empty.
+	if( (::ftruncate(m_fd, 0) != 0) || (::ftruncate(m_fd, static_cast<off_t>(m_size)) != 0) )
+	{
+		throw system_error( "ftruncate " + m_path );
+	}
+
+	mp_data = ::mmap( nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0 );
+	if( mp_data == MAP_FAILED )
+	{
+		throw system_error( "mmap " + m_path );
+	}
+
+	File_Header & header = *static_cast<File_Header *>( mp_data );
+	std::memcpy( header.magic, file_magic, sizeof(file_magic) );
+	header.version = format_version;
+	header.slot_size = slot_size;
+	header.bucket_count = m_bucket_count;
+	header.slots_per_bucket = slots_per_bucket;
+	header.checksum = fnv1a( &header, offsetof(File_Header, checksum) );
+}
+
+
+Mapped_Add_Result_Cache::Slot & Mapped_Add_Result_Cache::slot( size_t index ) const
+{
+	return reinterpret_cast<Slot *>( static_cast<char *>(mp_data) + sizeof(File_Header) )[index];
+}
+
+
+// A slot that fails its checksum is counted and freed for reuse.
+Mapped_Add_Result_Cache::Slot * Mapped_Add_Result_Cache::find_slot( size_t bucket, uint64_t hash, std::string_view expression )
+{
+	for( size_t i = bucket * slots_per_bucket; i < (bucket + 1) * slots_per_bucket; ++i )
+	{
+		Slot & s = slot( i );
+
+		if( ((s.flags & Slot::occupied) == 0) || (s.hash != hash) || (s.expression_size != expression.size()) )
+		{
+			continue;
+		}
+
+		const bool sizes_fit = (static_cast<size_t>(s.expression_size) + s.message_size) <= Slot::payload_size;
+		if( !sizes_fit || (s.checksum != fnv1a(&s.hash, offsetof(Slot, payload) - offsetof(Slot, hash) + s.expression_size + s.message_size)) )
+		{
+			++m_corrupt_slot_count;
+			s.flags = 0;
+			continue;
+		}
+
+		if( std::memcmp(s.payload, expression.data(), expression.size()) == 0 )
+		{
+			return &s;
+		}
+	}
+
+	return nullptr;
+}
+
+
+// A free slot if the bucket has one, otherwise the first slot the clock
+// hand reaches that has not been hit since it last came round.
+size_t Mapped_Add_Result_Cache::victim( size_t bucket )
+{
+	const size_t first = bucket * slots_per_bucket;
+
+	for( size_t i = first; i < first + slots_per_bucket; ++i )
+	{
+		if( (slot(i).flags & Slot::occupied) == 0 )
+		{
+			return i;
+		}
+	}
+
+	uint8_t & hand = m_clock_hands[bucket];
+
+	while( m_referenced[first + hand] )
+	{
+		m_referenced[first + hand] = 0;
+		hand = static_cast<uint8_t>( (hand + 1) % slots_per_bucket );
+	}
+
+	const size_t index = first + hand;
+	hand = static_cast<uint8_t>( (hand + 1) % slots_per_bucket );
+	return index;
+}
+
+
+std::mutex & Mapped_Add_Result_Cache::lock_for( size_t bucket ) const
+{
+	return mp_locks[bucket % lock_count];
+}
@@ -0,0 +1,101 @@
+#include "Mapped_File.h"
+
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+	std::system_error system_error( const std::string & what )
+	{
+		return std::system_error( errno, std::generic_category(), what );
+	}
+}
+
+
+Mapped_File::Mapped_File( const std::string & path ) :
+	mp_data( nullptr ),
+	m_size( 0 )
+{
+	const int fd = ::open( path.c_str(), O_RDONLY | O_CLOEXEC );
+	if( fd < 0 )
+	{
+		throw system_error( "open " + path );
+	}
+
+	try
+	{
+		map( fd, path );
+	}
+	catch( ... )
+	{
+		::close( fd );
+		throw;
+	}
+
+	::close( fd );
+}
+
+
+Mapped_File::Mapped_File( int fd, const std::string & path ) :
+	mp_data( nullptr ),
+	m_size( 0 )
+{
+	map( fd, path );
+}
+
+
+Mapped_File::~Mapped_File()
+{
+	if( m_size > 0 )
+	{
+		::munmap( mp_data, m_size );
+	}
+}
+
+
+std::string_view Mapped_File::contents() const
+{
+	return std::string_view( static_cast<const char *>(mp_data), m_size );
+}
+
+
+bool Mapped_File::is_mappable( int fd )
+{
+	struct stat status;
+	return (::fstat(fd, &status) == 0) && S_ISREG(status.st_mode) && (status.st_size > 0);
+}
+
+
+void Mapped_File::map( int fd, const std::string & path )
+{
+	struct stat status;
+	if( ::fstat(fd, &status) != 0 )
+	{
+		throw system_error( "fstat " + path );
+	}
+
+	// Only a regular file's size says how much there is to read.
+	if( !S_ISREG(status.st_mode) )
+	{
+		throw std::system_error( std::make_error_code(std::errc::no_such_device), "mmap " + path );
+	}
+
+	m_size = static_cast<size_t>( status.st_size );
+
+	// mmap() refuses empty mappings, and an empty file needs none.
+	if( m_size > 0 )
+	{
+		mp_data = ::mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+		if( mp_data == MAP_FAILED )
+		{
+			throw system_error( "mmap " + path );
+		}
+
+		::madvise( mp_data, m_size, MADV_SEQUENTIAL );
+	}
+}
@@ -0,0 +1,78 @@
+#include "Number_Parser.h"
+
+#include <climits>
+#include <cstdint>
+
+namespace
+{
+	bool is_space( char c )
+	{
+		return (c == ' ') || ((c >= '\t') && (c <= '\r'));
+	}
+
+	bool is_digit( char c )
+	{
+		return (c >= '0') && (c <= '9');
+	}
+}
+
+
+Number_Parser::Result Number_Parser::parse( std::string_view token, int & number ) const
+{
+	size_t pos = 0;
+
+	while( (pos < token.size()) && is_space(token[pos]) )
+	{
+		++pos;
+	}
+
+	bool is_negative = false;
+	if( (pos < token.size()) && ((token[pos] == '-') || (token[pos] == '+')) )
+	{
+		is_negative = (token[pos] == '-');
+		++pos;
+	}
+
+	if( (pos == token.size()) || !is_digit(token[pos]) )
+	{
+		return Result::invalid;
+	}
+
+	while( (pos < token.size()) && (token[pos] == '0') )
+	{
+		++pos;
+	}
+
+	const size_t digits_start = pos;
+	while( (pos < token.size()) && is_digit(token[pos]) )
+	{
+		++pos;
+	}
+
+	const std::string_view digits( token.substr(digits_start, pos - digits_start) );
+
+	if( !is_negative && (digits.size() > max_significant_digits) )
+	{
+		return Result::too_large;
+	}
+
+	if( digits.size() > max_int_digits )
+	{
+		return Result::out_of_range;
+	}
+
+	int64_t magnitude = 0;
+	for( char digit : digits )
+	{
+		magnitude = (magnitude * 10) + (digit - '0');
+	}
+
+	const int64_t value = is_negative ? -magnitude : magnitude;
+	if( value < INT_MIN )
+	{
+		return Result::out_of_range;
+	}
+
+	number = static_cast<int>( value );
+	return Result::number;
+}
@@ -0,0 +1,309 @@
+#include "Parsed_Expression.h"
+
+#include <stdexcept>
+
+#include "Token_Visitor_Interface.h"
+#include "Tokenizer_Interface.h"
+
+namespace
+{
+	class Token_Appender : public Token_Visitor_Interface
+	{
+		public:
+
+			explicit Token_Appender( std::vector<std::string> & tokens ) :
+				m_tokens( tokens )
+			{
+			}
+
+			void token_found( std::string_view token ) override
+			{
+				m_tokens.emplace_back( token );
+			}
+
+		private:
+
+			std::vector<std::string> & m_tokens;
+	};
+}
+
+
+Parsed_Expression::Parsed_Expression( const Tokenizer_Interface & tokenizer, const std::string & expression ) :
+	m_nodes(),
+	m_free_nodes(),
+	m_root( no_node ),
+	m_random_state( 2463534242u ),
+	m_classifier(),
+	m_checks_overflow( false )
+{
+	std::vector<std::string> tokens;
+	Token_Appender appender( tokens );
+	tokenizer.visit_tokens( expression, appender );
+
+	m_nodes.reserve( tokens.size() );
+	for( const std::string & token : tokens )
+	{
+		m_root = merge( m_root, new_node(token) );
+	}
+}
+
+
+size_t Parsed_Expression::token_count() const
+{
+	return size_of( m_root );
+}
+
+
+const std::string & Parsed_Expression::token( size_t index ) const
+{
+	return m_nodes[find( index )].token;
+}
+
+
+void Parsed_Expression::replace( size_t index, std::string_view token )
+{
+	const uint32_t node = find( index );
+	set_token( m_nodes[node], token );
+
+	// Cutting the node out and putting it back brings the sums above it up
+	// to date.
+	uint32_t left = no_node;
+	uint32_t middle = no_node;
+	uint32_t right = no_node;
+	split( m_root, index, left, middle );
+	split( middle, 1, middle, right );
+	m_root = merge( merge(left, middle), right );
+}
+
+
+void Parsed_Expression::insert( size_t index, std::string_view token )
+{
+	if( index > token_count() )
+	{
+		throw std::out_of_range( "Parsed_Expression::insert" );
+	}
+
+	const uint32_t node = new_node( token );
+
+	uint32_t left = no_node;
+	uint32_t right = no_node;
+	split( m_root, index, left, right );
+	m_root = merge( merge(left, node), right );
+}
+
+
+void Parsed_Expression::erase( size_t index )
+{
+	uint32_t left = no_node;
+	uint32_t middle = no_node;
+	uint32_t right = no_node;
+
+	find( index );
+	split( m_root, index, left, middle );
+	split( middle, 1, middle, right );
+	m_root = merge( left, right );
+
+	m_nodes[middle].token.clear();
+	m_free_nodes.push_back( middle );
+}
+
+
+int Parsed_Expression::total() const
+{
+	if( negative_count() > 0 )
+	{
+		Sum_Accumulator accumulator;
+		collect_negatives( m_root, accumulator );
+		accumulator.throw_if_has_negative_number();
+	}
+
+	return (m_root == no_node) ? 0 : checked_total( m_nodes[m_root].sum );
+}
+
+
+size_t Parsed_Expression::negative_count() const
+{
+	return (m_root == no_node) ? 0 : m_nodes[m_root].negative_count;
+}
+
+
+void Parsed_Expression::set_overflow_checking( bool enabled )
+{
+	m_checks_overflow = enabled;
+}
+
+
+// Classifies the token before taking a node, so a bad token leaves
+// everything as it was.
+uint32_t Parsed_Expression::new_node( std::string_view token )
+{
+	Node node { std::string(), 0, 0, 0, no_node, no_node, 1, 0, 0 };
+	set_token( node, token );
+
+	// xorshift32
+	m_random_state ^= m_random_state << 13;
+	m_random_state ^= m_random_state >> 17;
+	m_random_state ^= m_random_state << 5;
+	node.priority = m_random_state;
+
+	uint32_t index = 0;
+	if( m_free_nodes.empty() )
+	{
+		index = static_cast<uint32_t>( m_nodes.size() );
+		m_nodes.push_back( std::move(node) );
+	}
+	else
+	{
+		index = m_free_nodes.back();
+		m_free_nodes.pop_back();
+		m_nodes[index] = std::move( node );
+	}
+
+	update( index );
+	return index;
+}
+
+
+// A Sum_Accumulator fed the one token applies exactly the rules add() does.
+// It throws for a bad token before the node is touched.
+void Parsed_Expression::set_token( Node & node, std::string_view token )
+{
+	m_classifier.reset();
+	m_classifier.token_found( token );
+
+	node.token.assign( token );
+	node.value = m_classifier.total();
+	node.number = m_classifier.has_negative_numbers() ? m_classifier.negative_number( 0 ) : 0;
+}
+
+
+void Parsed_Expression::update( uint32_t node )
+{
+	Node & n = m_nodes[node];
+	n.size = 1 + size_of( n.left ) + size_of( n.right );
+	n.sum = n.value;
+	n.negative_count = (n.number < 0) ? 1 : 0;
+
+	for( uint32_t child : { n.left, n.right } )
+	{
+		if( child != no_node )
+		{
+			n.sum += m_nodes[child].sum;
+			n.negative_count += m_nodes[child].negative_count;
+		}
+	}
+}
+
+
+size_t Parsed_Expression::size_of( uint32_t node ) const
+{
+	return (node == no_node) ? 0 : m_nodes[node].size;
+}
+
+
+uint32_t Parsed_Expression::merge( uint32_t left, uint32_t right )
+{
+	if( left == no_node )
+	{
+		return right;
+	}
+
+	if( right == no_node )
+	{
+		return left;
+	}
+
+	if( m_nodes[left].priority > m_nodes[right].priority )
+	{
+		m_nodes[left].right = merge( m_nodes[left].right, right );
+		update( left );
+		return left;
+	}
+
+	m_nodes[right].left = merge( left, m_nodes[right].left );
+	update( right );
+	return right;
+}
+
+
+// The first count tokens under node go to left and the rest to right.
+void Parsed_Expression::split( uint32_t node, size_t count, uint32_t & left, uint32_t & right )
+{
+	if( node == no_node )
+	{
+		left = no_node;
+		right = no_node;
+		return;
+	}
+
+	if( size_of(m_nodes[node].left) < count )
+	{
+		split( m_nodes[node].right, count - size_of(m_nodes[node].left) - 1, m_nodes[node].right, right );
+		left = node;
+	}
+	else
+	{
+		split( m_nodes[node].left, count, left, m_nodes[node].left );
+		right = node;
+	}
+
+	update( node );
+}
+
+
+uint32_t Parsed_Expression::find( size_t index ) const
+{
+	if( index >= token_count() )
+	{
+		throw std::out_of_range( "Parsed_Expression: no token " + std::to_string(index) );
+	}
+
+	uint32_t node = m_root;
+
+	while( true )
+	{
+		const size_t left_size = size_of( m_nodes[node].left );
+
+		if( index < left_size )
+		{
+			node = m_nodes[node].left;
+		}
+		else if( index == left_size )
+		{
+			return node;
+		}
+		else
+		{
+			index -= left_size + 1;
+			node = m_nodes[node].right;
+		}
+	}
+}
+
+
+// Visits only the subtrees that hold negatives, in order.
+void Parsed_Expression::collect_negatives( uint32_t node, Sum_Accumulator & accumulator ) const
+{
+	if( (node == no_node) || (m_nodes[node].negative_count == 0) )
+	{
+		return;
+	}
+
+	collect_negatives( m_nodes[node].left, accumulator );
+	if( m_nodes[node].number < 0 )
+	{
+		accumulator.add_number( m_nodes[node].number );
+	}
+	collect_negatives( m_nodes[node].right, accumulator );
+}
+
+
+int Parsed_Expression::checked_total( int64_t total ) const
+{
+	if( m_checks_overflow && !Sum_Accumulator::fits_in_int(total) )
+	{
+		throw std::overflow_error( Sum_Accumulator::total_out_of_range_message() );
+	}
+
+	return static_cast<int>( total );
+}
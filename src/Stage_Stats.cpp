@@ -0,0 +1,127 @@
+#include "Stage_Stats.h"
+
+#ifdef STRING_CALCULATOR_STATS
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	// Written only by the thread that owns it, and read by snapshot().
+	struct Thread_Counters
+	{
+		struct Stage
+		{
+			std::atomic<uint64_t> calls;
+			std::atomic<uint64_t> nanoseconds;
+			std::atomic<uint64_t> bytes;
+			std::atomic<uint64_t> tokens;
+		};
+
+		std::array<Stage, Stage_Stats::stage_count> stages {};
+	};
+
+	void add_to( std::atomic<uint64_t> & counter, uint64_t amount )
+	{
+		counter.store( counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed );
+	}
+
+	void add_to( Stage_Stats::Snapshot & snapshot, const Thread_Counters & counters )
+	{
+		for( size_t stage = 0; stage < Stage_Stats::stage_count; ++stage )
+		{
+			snapshot.stages[stage].calls += counters.stages[stage].calls.load( std::memory_order_relaxed );
+			snapshot.stages[stage].nanoseconds += counters.stages[stage].nanoseconds.load( std::memory_order_relaxed );
+			snapshot.stages[stage].bytes += counters.stages[stage].bytes.load( std::memory_order_relaxed );
+			snapshot.stages[stage].tokens += counters.stages[stage].tokens.load( std::memory_order_relaxed );
+		}
+	}
+
+	// The counters of every live thread, plus what threads that have since
+	// exited left behind.  Never destroyed, so that threads exiting during
+	// static destruction can still fold their counters in.
+	struct Registry
+	{
+		std::mutex mutex;
+		std::vector<Thread_Counters *> live;
+		Stage_Stats::Snapshot retired {};
+	};
+
+	Registry & registry()
+	{
+		static Registry * const p_registry = new Registry();
+		return *p_registry;
+	}
+
+	struct Thread_Registration
+	{
+		Thread_Registration()
+		{
+			Registry & r = registry();
+			std::lock_guard<std::mutex> lock( r.mutex );
+			r.live.push_back( &counters );
+		}
+
+		~Thread_Registration()
+		{
+			Registry & r = registry();
+			std::lock_guard<std::mutex> lock( r.mutex );
+			add_to( r.retired, counters );
+			r.live.erase( std::find(r.live.begin(), r.live.end(), &counters) );
+		}
+
+		Thread_Counters counters;
+	};
+
+	thread_local Thread_Registration t_registration;
+}
+
+
+Stage_Stats::Snapshot Stage_Stats::snapshot()
+{
+	Registry & r = registry();
+	std::lock_guard<std::mutex> lock( r.mutex );
+
+	Snapshot snapshot = r.retired;
+	for( Thread_Counters * p_counters : r.live )
+	{
+		add_to( snapshot, *p_counters );
+	}
+
+	return snapshot;
+}
+
+
+// Counters being recorded into at the same time may keep a little of what
+// they had.
+void Stage_Stats::reset()
+{
+	Registry & r = registry();
+	std::lock_guard<std::mutex> lock( r.mutex );
+
+	r.retired = Snapshot();
+	for( Thread_Counters * p_counters : r.live )
+	{
+		for( Thread_Counters::Stage & stage : p_counters->stages )
+		{
+			stage.calls.store( 0, std::memory_order_relaxed );
+			stage.nanoseconds.store( 0, std::memory_order_relaxed );
+			stage.bytes.store( 0, std::memory_order_relaxed );
+			stage.tokens.store( 0, std::memory_order_relaxed );
+		}
+	}
+}
+
+
+void Stage_Stats::record( Add_Stage stage, uint64_t nanoseconds, uint64_t bytes, uint64_t tokens )
+{
+	Thread_Counters::Stage & counters = t_registration.counters.stages[static_cast<size_t>(stage)];
+	add_to( counters.calls, 1 );
+	add_to( counters.nanoseconds, nanoseconds );
+	add_to( counters.bytes, bytes );
+	add_to( counters.tokens, tokens );
+}
+
+#endif /*STRING_CALCULATOR_STATS*/
@@ -1,24 +1,50 @@
 #include "String_Calculator.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <memory_resource>
 #include <stdexcept>
-#include <sstream>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "Add_Observer_Interface.h"
+#include "Add_Result_Cache_Interface.h"
+#include "Expression_Format.h"
+#include "Fd_Byte_Source.h"
+#include "Istream_Byte_Source.h"
+#include "Mapped_File.h"
+#include "Stage_Stats.h"
+#include "Sum_Accumulator.h"
 #include "Tokenizer_Interface.h"
+#include "Work_Stealing_Executor.h"
 
-
-String_Calculator::String_Calculator( Tokenizer_Interface & tokenizer ) :
+String_Calculator::String_Calculator( Tokenizer_Interface & tokenizer, std::pmr::memory_resource * p_resource ) :
 	m_add_call_count( 0 ),
 	m_tokenizer( tokenizer ),
-	mp_observer( nullptr )
+	mp_observer( nullptr ),
+	mp_result_cache( nullptr ),
+	m_checks_overflow( false ),
+	m_scratch_buffer(),
+	m_scratch( m_scratch_buffer, scratch_buffer_size, p_resource )
 {
 }
 
 
-String_Calculator::String_Calculator( Tokenizer_Interface & tokenizer, Add_Observer_Interface & observer ) :
+String_Calculator::String_Calculator( Tokenizer_Interface & tokenizer, Add_Observer_Interface & observer, std::pmr::memory_resource * p_resource ) :
 	m_add_call_count( 0 ),
 	m_tokenizer( tokenizer ),
-	mp_observer( &observer )
+	mp_observer( &observer ),
+	mp_result_cache( nullptr ),
+	m_checks_overflow( false ),
+	m_scratch_buffer(),
+	m_scratch( m_scratch_buffer, scratch_buffer_size, p_resource )
 {
 }
 
@@ -27,12 +53,22 @@ int String_Calculator::add( const std::string & expression )
 {
 	++m_add_call_count;
 
-	const std::vector<int> addends( parse_numbers(expression) );
+	if( (mp_result_cache != nullptr) && (expression.size() <= mp_result_cache->max_expression_size()) )
+	{
+		return add_through_cache( expression );
+	}
 
-	throw_if_has_negative_number( addends );
-	const std::vector<int> filtered_addends( filter_out_large_numbers(addends) );
+	Sum_Accumulator accumulator( reset_scratch() );
+	{
+		Stage_Timer timer( Add_Stage::tokenize );
+		m_tokenizer.visit_tokens( expression, accumulator );
+		timer.add_bytes( expression.size() );
+		timer.add_tokens( accumulator.token_count() );
+	}
 
-	int total = sum( filtered_addends );
+	throw_if_has_negative_number( accumulator );
+
+	int total = checked_total( accumulator.wide_total() );
 
 	notify_add_occurred( expression, total );
 
@@ -40,90 +76,401 @@ int String_Calculator::add( const std::string & expression )
 }
 
 
-int String_Calculator::get_called_count() const
+int String_Calculator::add( const std::string & expression, Work_Stealing_Executor & executor )
 {
-	return m_add_call_count;
+	++m_add_call_count;
+
+	const size_t max_chunks = std::min( executor.thread_count() * chunks_per_thread, (expression.size() / min_chunk_size) + 1 );
+	const std::unique_ptr<Chunked_Expression_Interface> p_chunks = m_tokenizer.cut_into_chunks( expression, max_chunks );
+	const size_t chunk_count = p_chunks->chunk_count();
+
+	// The arena is not thread-safe, so the chunks' own accumulators take
+	// whatever they need from the default resource.
+	std::pmr::memory_resource * const p_scratch = reset_scratch();
+	std::pmr::vector<Sum_Accumulator> accumulators( chunk_count, p_scratch );
+	std::pmr::vector<std::exception_ptr> exceptions( chunk_count, p_scratch );
+
+	executor.for_each( chunk_count,
+		[]( size_t ){ return size_t(1); },
+		[&]( size_t chunk )
+		{
+			try
+			{
+				Stage_Timer timer( Add_Stage::tokenize );
+				p_chunks->visit_chunk_tokens( chunk, accumulators[chunk] );
+				timer.add_tokens( accumulators[chunk].token_count() );
+			}
+			catch( ... )
+			{
+				exceptions[chunk] = std::current_exception();
+			}
+		} );
+
+	// Merge in chunk order so that the first bad token and the negatives
+	// are reported just as the serial add() would.
+	Sum_Accumulator accumulator( p_scratch );
+	for( size_t chunk = 0; chunk < chunk_count; ++chunk )
+	{
+		if( exceptions[chunk] )
+		{
+			std::rethrow_exception( exceptions[chunk] );
+		}
+
+		accumulator.merge( accumulators[chunk] );
+	}
+
+	throw_if_has_negative_number( accumulator );
+
+	int total = checked_total( accumulator.wide_total() );
+
+	notify_add_occurred( expression, total );
+
+	return total;
 }
 
 
-std::vector<int> String_Calculator::parse_numbers( const std::string & expression ) const
+int String_Calculator::add( const std::string & body, const Expression_Format & format )
 {
-	const std::vector<std::string> tokens( m_tokenizer.parse_tokens(expression) );
-	return strings_to_ints( tokens );
+	++m_add_call_count;
+
+	Sum_Accumulator accumulator( reset_scratch() );
+	{
+		Stage_Timer timer( Add_Stage::tokenize );
+		m_tokenizer.visit_body_tokens( body, format, accumulator );
+		timer.add_bytes( body.size() );
+		timer.add_tokens( accumulator.token_count() );
+	}
+
+	throw_if_has_negative_number( accumulator );
+
+	int total = checked_total( accumulator.wide_total() );
+
+	notify_add_occurred( body, total );
+
+	return total;
+}
+
+
+int String_Calculator::add( std::istream & input )
+{
+	Istream_Byte_Source source( input );
+	return add_from( source );
 }
 
 
-int String_Calculator::sum( const std::vector<int> & addends ) const
+int String_Calculator::add_fd( int fd )
 {
-	int accumulator = 0;
+	Fd_Byte_Source source( fd );
+	return add_from( source );
+}
+
 
-	for( int addend : addends )
+int String_Calculator::add_file( const std::string & path )
+{
+	const int fd = ::open( path.c_str(), O_RDONLY | O_CLOEXEC );
+	if( fd < 0 )
 	{
-		accumulator += addend;
+		throw std::system_error( errno, std::generic_category(), "open " + path );
 	}
 
-	return accumulator;
+	try
+	{
+		const int total = Mapped_File::is_mappable( fd ) ? add_mapped( Mapped_File(fd, path) ) : add_fd( fd );
+		::close( fd );
+		return total;
+	}
+	catch( ... )
+	{
+		::close( fd );
+		throw;
+	}
 }
 
 
-std::vector<int> String_Calculator::strings_to_ints( const std::vector<std::string> & strs ) const
+void String_Calculator::add_batch( const std::string * expressions, size_t count, int * results, std::string * error_messages )
 {
-	std::vector<int> ints;
+	m_add_call_count += static_cast<int>( count );
+
+	Sum_Accumulator accumulator( reset_scratch() );
 
-	for( const std::string & str : strs )
+	for( size_t i = 0; i < count; ++i )
 	{
-		ints.push_back( std::stoi(str) );
+		accumulator.reset();
+
+		if( evaluate(expressions[i], accumulator, results[i], error_messages[i]) )
+		{
+			notify_add_occurred( expressions[i], results[i] );
+		}
 	}
+}
+
+
+void String_Calculator::add_batch( const std::string * expressions, size_t count, int * results, std::string * error_messages, Work_Stealing_Executor & executor )
+{
+	m_add_call_count += static_cast<int>( count );
+
+	std::pmr::vector<char> succeeded( count, 0, reset_scratch() );
 
-	return ints;
+	executor.for_each( count,
+		[&]( size_t i ){ return expressions[i].size(); },
+		[&]( size_t i )
+		{
+			Sum_Accumulator accumulator;
+			succeeded[i] = evaluate( expressions[i], accumulator, results[i], error_messages[i] );
+		} );
+
+	for( size_t i = 0; i < count; ++i )
+	{
+		if( succeeded[i] )
+		{
+			notify_add_occurred( expressions[i], results[i] );
+		}
+	}
 }
 
-void String_Calculator::throw_if_has_negative_number( const std::vector<int> & numbers ) const
+
+Add_Result String_Calculator::try_add( const std::string & expression, size_t max_reported_negatives )
 {
-	bool has_negatives = false;
-	std::ostringstream message;
-	message << "negatives not allowed:";
+	++m_add_call_count;
+
+	Sum_Accumulator accumulator( reset_scratch() );
 
-	for( int number : numbers )
+	// The accumulator can only report a bad token by throwing, but that is
+	// rare next to negatives, which are reported without unwinding.
+	try
+	{
+		Stage_Timer timer( Add_Stage::tokenize );
+		m_tokenizer.visit_tokens( expression, accumulator );
+		timer.add_bytes( expression.size() );
+		timer.add_tokens( accumulator.token_count() );
+	}
+	catch( const std::out_of_range & e )
 	{
-		if( number < 0 )
+		return Add_Error( Add_Error::Kind::number_out_of_range, e.what() );
+	}
+	catch( const std::invalid_argument & e )
+	{
+		return Add_Error( Add_Error::Kind::invalid_number, e.what() );
+	}
+
+	{
+		Stage_Timer timer( Add_Stage::negative_check );
+
+		if( accumulator.has_negative_numbers() )
 		{
-			has_negatives = true;
-			message << " " << number;
+			const size_t reported_count = std::min( accumulator.negative_number_count(), max_reported_negatives );
+			std::vector<Negative_Number> negative_numbers( reported_count );
+
+			for( size_t i = 0; i < reported_count; ++i )
+			{
+				negative_numbers[i].value = accumulator.negative_number( i );
+				negative_numbers[i].position = position_in( expression, accumulator.negative_token(i) );
+			}
+
+			return Add_Error( std::move(negative_numbers), accumulator.negative_number_count() );
 		}
 	}
 
-	if( has_negatives )
+	if( m_checks_overflow && !accumulator.total_fits_in_int() )
 	{
-		throw std::invalid_argument( message.str() );
+		return Add_Error( Add_Error::Kind::total_out_of_range, Sum_Accumulator::total_out_of_range_message() );
 	}
+
+	int total = accumulator.total();
+
+	notify_add_occurred( expression, total );
+
+	return total;
 }
 
 
-void String_Calculator::notify_add_occurred( const std::string & expression, int result ) const
+void String_Calculator::set_result_cache( Add_Result_Cache_Interface * p_cache )
 {
-	if( mp_observer != nullptr )
+	mp_result_cache = p_cache;
+}
+
+
+void String_Calculator::set_overflow_checking( bool enabled )
+{
+	m_checks_overflow = enabled;
+}
+
+
+int String_Calculator::get_called_count() const
+{
+	return m_add_call_count;
+}
+
+
+// Tokenizers that copy tokens out of the expression, as parse_tokens()
+// does, leave no way of telling where they came from.
+size_t String_Calculator::position_in( const std::string & expression, const char * p_token )
+{
+	const std::less<const char *> before;
+
+	if( (p_token == nullptr) || before(p_token, expression.data()) || before(expression.data() + expression.size(), p_token) )
 	{
-		mp_observer->add_occurred( expression, result );
+		return Negative_Number::npos;
 	}
+
+	return static_cast<size_t>( p_token - expression.data() );
 }
 
 
-std::vector<int> String_Calculator::filter_out_large_numbers( const std::vector<int> & numbers ) const
+// Nothing allocated from the arena outlives the call that allocated it.
+std::pmr::memory_resource * String_Calculator::reset_scratch()
 {
-	const int max_allowable_number = 1000;
+	m_scratch.release();
+	return &m_scratch;
+}
+
 
-	std::vector<int> accepted_numbers;
+int String_Calculator::add_from( Byte_Source_Interface & source )
+{
+	++m_add_call_count;
 
-	for( int number : numbers )
+	Sum_Accumulator accumulator( reset_scratch() );
 	{
-		if( number <= max_allowable_number )
+		Stage_Timer timer( Add_Stage::tokenize );
+		m_tokenizer.visit_source_tokens( source, accumulator );
+		timer.add_tokens( accumulator.token_count() );
+	}
+
+	throw_if_has_negative_number( accumulator );
+
+	int total = checked_total( accumulator.wide_total() );
+
+	notify_add_occurred( std::string(), total );
+
+	return total;
+}
+
+
+int String_Calculator::add_mapped( const Mapped_File & file )
+{
+	++m_add_call_count;
+
+	Sum_Accumulator accumulator( reset_scratch() );
+	{
+		Stage_Timer timer( Add_Stage::tokenize );
+		m_tokenizer.visit_tokens( file.contents(), accumulator );
+		timer.add_bytes( file.contents().size() );
+		timer.add_tokens( accumulator.token_count() );
+	}
+
+	throw_if_has_negative_number( accumulator );
+
+	int total = checked_total( accumulator.wide_total() );
+
+	notify_add_occurred( std::string(), total );
+
+	return total;
+}
+
+
+// Only totals and negatives are cached; a bad token is found again on
+// every call.  Totals are stored whole, so that a calculator sharing the
+// cache applies its own overflow checking to them.
+int String_Calculator::add_through_cache( const std::string & expression )
+{
+	Add_Result_Cache_Interface::Entry entry { false, 0, std::string() };
+
+	if( mp_result_cache->find(expression, entry) )
+	{
+		if( entry.has_negative_numbers )
 		{
-			accepted_numbers.push_back( number );
+			throw std::invalid_argument( entry.negative_numbers_message );
 		}
+
+		const int total = checked_total( entry.total );
+		notify_add_occurred( expression, total );
+		return total;
+	}
+
+	Sum_Accumulator accumulator( reset_scratch() );
+	{
+		Stage_Timer timer( Add_Stage::tokenize );
+		m_tokenizer.visit_tokens( expression, accumulator );
+		timer.add_bytes( expression.size() );
+		timer.add_tokens( accumulator.token_count() );
+	}
+
+	if( accumulator.has_negative_numbers() )
+	{
+		const std::string message( accumulator.negative_numbers_message() );
+		mp_result_cache->store_negative_numbers( expression, message );
+		throw std::invalid_argument( message );
 	}
 
-	return accepted_numbers;
+	mp_result_cache->store_total( expression, accumulator.wide_total() );
+	int total = checked_total( accumulator.wide_total() );
+
+	notify_add_occurred( expression, total );
+
+	return total;
 }
 
 
+bool String_Calculator::evaluate( const std::string & expression, Sum_Accumulator & accumulator, int & result, std::string & error_message ) const
+{
+	result = 0;
+
+	try
+	{
+		Stage_Timer timer( Add_Stage::tokenize );
+		m_tokenizer.visit_tokens( expression, accumulator );
+		timer.add_bytes( expression.size() );
+		timer.add_tokens( accumulator.token_count() );
+	}
+	catch( const std::exception & e )
+	{
+		error_message = e.what();
+		return false;
+	}
+
+	Stage_Timer timer( Add_Stage::negative_check );
+	if( accumulator.has_negative_numbers() )
+	{
+		error_message = accumulator.negative_numbers_message();
+		return false;
+	}
+
+	if( m_checks_overflow && !accumulator.total_fits_in_int() )
+	{
+		error_message = Sum_Accumulator::total_out_of_range_message();
+		return false;
+	}
+
+	result = accumulator.total();
+	error_message.clear();
+	return true;
+}
+
+
+void String_Calculator::throw_if_has_negative_number( const Sum_Accumulator & accumulator ) const
+{
+	Stage_Timer timer( Add_Stage::negative_check );
+	accumulator.throw_if_has_negative_number();
+}
+
+
+int String_Calculator::checked_total( int64_t total ) const
+{
+	if( m_checks_overflow && !Sum_Accumulator::fits_in_int(total) )
+	{
+		throw std::overflow_error( Sum_Accumulator::total_out_of_range_message() );
+	}
+
+	return static_cast<int>( total );
+}
+
+
+void String_Calculator::notify_add_occurred( const std::string & expression, int result ) const
+{
+	if( mp_observer != nullptr )
+	{
+		Stage_Timer timer( Add_Stage::notify );
+		mp_observer->add_occurred( expression, result );
+	}
+}
+
@@ -0,0 +1,243 @@
+#include "Sum_Accumulator.h"
+
+#include <limits>
+#include <stdexcept>
+#include <sstream>
+
+#include "Filter_Sum_Kernel.h"
+
+
+Sum_Accumulator::Sum_Accumulator() :
+	m_number_parser(),
+	m_total( 0 ),
+	m_token_count( 0 ),
+	m_negative_numbers(),
+	m_negative_tokens()
+{
+}
+
+
+Sum_Accumulator::Sum_Accumulator( std::pmr::memory_resource * p_resource ) :
+	m_number_parser(),
+	m_total( 0 ),
+	m_token_count( 0 ),
+	m_negative_numbers( p_resource ),
+	m_negative_tokens( p_resource )
+{
+}
+
+
+void Sum_Accumulator::token_found( std::string_view token )
+{
+	if constexpr( Stage_Stats::enabled )
+	{
+		++m_token_count;
+	}
+
+	int number = 0;
+
+	switch( m_number_parser.parse(token, number) )
+	{
+		case Number_Parser::Result::number:
+			add_number( number, token.data() );
+			break;
+		case Number_Parser::Result::too_large:
+			break;
+		case Number_Parser::Result::invalid:
+			throw std::invalid_argument( "stoi" );
+		case Number_Parser::Result::out_of_range:
+			throw std::out_of_range( "stoi" );
+	}
+}
+
+
+void Sum_Accumulator::number_found( std::string_view token, int number )
+{
+	if constexpr( Stage_Stats::enabled )
+	{
+		++m_token_count;
+	}
+
+	add_number( number, token.data() );
+}
+
+
+void Sum_Accumulator::numbers_found( const std::string_view * tokens, const int * numbers, size_t count )
+{
+	if constexpr( Stage_Stats::enabled )
+	{
+		m_token_count += count;
+	}
+
+	add_numbers( numbers, tokens, count );
+}
+
+
+void Sum_Accumulator::add_number( int number )
+{
+	add_number( number, nullptr );
+}
+
+
+void Sum_Accumulator::add_numbers( const int * numbers, size_t count )
+{
+	add_numbers( numbers, nullptr, count );
+}
+
+
+// Runs shorter than a vector are not worth the call into the kernel.
+void Sum_Accumulator::add_numbers( const int * numbers, const std::string_view * tokens, size_t count )
+{
+	if( count < min_kernel_count )
+	{
+		for( size_t i = 0; i < count; ++i )
+		{
+			add_number( numbers[i], (tokens != nullptr) ? tokens[i].data() : nullptr );
+		}
+		return;
+	}
+
+	const Filter_Sum_Kernel::Result result = Filter_Sum_Kernel::best_available().filter_sum( numbers, count, max_allowable_number );
+	m_total += result.total;
+
+	// Negatives are rare, so the numbers are only walked again, in order,
+	// when the kernel says there are some.
+	if( result.has_negative_numbers )
+	{
+		for( size_t i = 0; i < count; ++i )
+		{
+			if( numbers[i] < 0 )
+			{
+				m_negative_numbers.push_back( numbers[i] );
+				m_negative_tokens.push_back( (tokens != nullptr) ? tokens[i].data() : nullptr );
+			}
+		}
+	}
+}
+
+
+// The same rule as Filter_Sum_Kernel's scalar kernel, so that whether a
+// number is summed costs no branch.
+void Sum_Accumulator::add_number( int number, const char * p_token )
+{
+	const uint32_t value = static_cast<uint32_t>( number );
+	const uint32_t keep_mask = -static_cast<uint32_t>( value <= static_cast<uint32_t>(max_allowable_number) );
+	m_total += value & keep_mask;
+
+	if( number < 0 )
+	{
+		m_negative_numbers.push_back( number );
+		m_negative_tokens.push_back( p_token );
+	}
+}
+
+
+void Sum_Accumulator::merge( const Sum_Accumulator & other )
+{
+	m_total += other.m_total;
+	m_token_count += other.m_token_count;
+	m_negative_numbers.insert( m_negative_numbers.end(), other.m_negative_numbers.begin(), other.m_negative_numbers.end() );
+	m_negative_tokens.insert( m_negative_tokens.end(), other.m_negative_tokens.begin(), other.m_negative_tokens.end() );
+}
+
+
+int Sum_Accumulator::total() const
+{
+	return static_cast<int>( m_total );
+}
+
+
+int64_t Sum_Accumulator::wide_total() const
+{
+	return m_total;
+}
+
+
+bool Sum_Accumulator::total_fits_in_int() const
+{
+	return fits_in_int( m_total );
+}
+
+
+void Sum_Accumulator::throw_if_total_out_of_range() const
+{
+	if( !total_fits_in_int() )
+	{
+		throw std::overflow_error( total_out_of_range_message() );
+	}
+}
+
+
+// Totals are never negative.
+bool Sum_Accumulator::fits_in_int( int64_t total )
+{
+	return total <= std::numeric_limits<int>::max();
+}
+
+
+const char * Sum_Accumulator::total_out_of_range_message()
+{
+	return "total out of range";
+}
+
+
+size_t Sum_Accumulator::token_count() const
+{
+	return m_token_count;
+}
+
+
+bool Sum_Accumulator::has_negative_numbers() const
+{
+	return !m_negative_numbers.empty();
+}
+
+
+size_t Sum_Accumulator::negative_number_count() const
+{
+	return m_negative_numbers.size();
+}
+
+
+int Sum_Accumulator::negative_number( size_t index ) const
+{
+	return m_negative_numbers[index];
+}
+
+
+const char * Sum_Accumulator::negative_token( size_t index ) const
+{
+	return m_negative_tokens[index];
+}
+
+
+std::string Sum_Accumulator::negative_numbers_message() const
+{
+	std::ostringstream message;
+	message << "negatives not allowed:";
+
+	for( int number : m_negative_numbers )
+	{
+		message << " " << number;
+	}
+
+	return message.str();
+}
+
+
+void Sum_Accumulator::throw_if_has_negative_number() const
+{
+	if( has_negative_numbers() )
+	{
+		throw std::invalid_argument( negative_numbers_message() );
+	}
+}
+
+
+void Sum_Accumulator::reset()
+{
+	m_total = 0;
+	m_token_count = 0;
+	m_negative_numbers.clear();
+	m_negative_tokens.clear();
+}
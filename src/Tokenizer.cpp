@@ -1,24 +1,211 @@
 #include "Tokenizer.h"
 
 #include <algorithm>
+#include <stdexcept>
+
+#include "Delimiter_Matcher.h"
+#include "Stage_Stats.h"
+
+namespace
+{
+	class Token_Collector : public Token_Visitor_Interface
+	{
+		public:
+
+			void token_found( std::string_view token ) override
+			{
+				tokens.emplace_back( token );
+			}
+
+			std::vector<std::string> tokens;
+	};
+
+	// The body of an expression cut at positions where Delimiter_Matcher
+	// says splitting either side on its own gives the same tokens.
+	class Body_Chunks : public Chunked_Expression_Interface
+	{
+		public:
+
+			Body_Chunks( std::string_view body, std::shared_ptr<const Delimiter_Header_Cache::Compiled_Header> p_header, const Default_Delimiter_Scanner & default_scanner, size_t max_chunks, std::pmr::memory_resource * p_resource ) :
+				mp_header( std::move(p_header) ),
+				m_default_scanner( default_scanner ),
+				m_chunks( p_resource )
+			{
+				size_t chunk_start = 0;
+
+				for( size_t chunk = 1; chunk < max_chunks; ++chunk )
+				{
+					const size_t target = (body.size() / max_chunks) * chunk;
+					const size_t cut = mp_header->matcher.next_safe_cut( body, std::max(target, chunk_start + 1) );
+
+					if( cut >= body.size() )
+					{
+						break;
+					}
+
+					m_chunks.push_back( body.substr(chunk_start, cut - chunk_start) );
+					chunk_start = cut;
+				}
+
+				m_chunks.push_back( body.substr(chunk_start) );
+			}
+
+			size_t chunk_count() const override
+			{
+				return m_chunks.size();
+			}
+
+			void visit_chunk_tokens( size_t chunk, Token_Visitor_Interface & visitor ) const override
+			{
+				if( mp_header->is_default_format )
+				{
+					m_default_scanner.split( m_chunks[chunk], visitor );
+				}
+				else
+				{
+					mp_header->matcher.split( m_chunks[chunk], visitor );
+				}
+			}
+
+		private:
+
+			const std::shared_ptr<const Delimiter_Header_Cache::Compiled_Header> mp_header;
+			const Default_Delimiter_Scanner & m_default_scanner;
+			std::pmr::vector<std::string_view> m_chunks;
+	};
+}
+
+
+Tokenizer::Tokenizer( size_t header_cache_capacity, std::pmr::memory_resource * p_scratch_resource ) :
+	mp_scratch_resource( p_scratch_resource ),
+	m_default_delimiter_scanner(),
+	mp_default_header( std::make_shared<const Compiled_Header>(Compiled_Header{ Delimiter_Matcher(default_delimiters()), true }) ),
+	m_header_cache( header_cache_capacity )
+{
+}
+
 
 std::vector<std::string> Tokenizer::parse_tokens( const std::string & expression ) const
 {
-	const auto [delimiters, header_size] = parse_delimiter_header( expression );
-	const std::string body( expression.substr(header_size) );
-	return split(body, delimiters);
+	Token_Collector collector;
+	visit_tokens( expression, collector );
+	return collector.tokens;
+}
+
+
+void Tokenizer::visit_tokens( std::string_view expression, Token_Visitor_Interface & visitor ) const
+{
+	size_t header_size = 0;
+	std::shared_ptr<const Compiled_Header> p_header;
+
+	{
+		Stage_Timer timer( Add_Stage::header );
+		header_size = delimiter_header_size( expression );
+
+		if( header_size != 0 )
+		{
+			p_header = compiled_header( expression.substr(0, header_size) );
+			timer.add_bytes( header_size );
+		}
+	}
+
+	if( header_size == 0 )
+	{
+		m_default_delimiter_scanner.split( expression, visitor );
+		return;
+	}
+
+	split_body( *p_header, expression.substr(header_size), visitor );
 }
 
 
-std::vector<std::string> Tokenizer::split( const std::string & expression, const std::set<std::string> & delimiters ) const
+void Tokenizer::visit_body_tokens( std::string_view body, const Expression_Format & format, Token_Visitor_Interface & visitor ) const
 {
-	const std::string standard_delimiter( "," );
-	std::string simpler_expression( replace_all(expression, delimiters, standard_delimiter) );
-	return split( simpler_expression, standard_delimiter );
+	if( format.is_default_format() )
+	{
+		m_default_delimiter_scanner.split( body, visitor );
+	}
+	else
+	{
+		format.matcher().split( body, visitor );
+	}
 }
 
 
-std::vector<std::string> Tokenizer::split( const std::string & expression, const std::string & delimiter ) const
+void Tokenizer::visit_source_tokens( Byte_Source_Interface & source, Token_Visitor_Interface & visitor ) const
+{
+	std::pmr::string buffer( mp_scratch_resource );
+	bool at_end = false;
+
+	const auto read_chunk = [&]()
+	{
+		const size_t old_size = buffer.size();
+		buffer.resize( old_size + source_chunk_size );
+		const size_t bytes_read = source.read( &buffer[old_size], source_chunk_size );
+		buffer.resize( old_size + bytes_read );
+		at_end = (bytes_read == 0);
+	};
+
+	do
+	{
+		read_chunk();
+	}
+	while( !at_end && !is_header_complete(buffer) );
+
+	const size_t header_size = delimiter_header_size( buffer );
+	const std::shared_ptr<const Compiled_Header> p_header = compiled_header( std::string_view(buffer).substr(0, header_size) );
+	const Delimiter_Matcher & matcher = p_header->matcher;
+	buffer.erase( 0, header_size );
+
+	// Hand on everything up to the last cut that more input can no longer
+	// move, and carry the rest over to the next chunk.
+	while( !at_end )
+	{
+		if( buffer.size() > matcher.longest_delimiter_size() )
+		{
+			const size_t cut = matcher.previous_safe_cut( buffer, buffer.size() - matcher.longest_delimiter_size() );
+			split_body( *p_header, std::string_view(buffer).substr(0, cut), visitor );
+			buffer.erase( 0, cut );
+		}
+
+		read_chunk();
+	}
+
+	split_body( *p_header, buffer, visitor );
+}
+
+
+std::unique_ptr<Chunked_Expression_Interface> Tokenizer::cut_into_chunks( std::string_view expression, size_t max_chunks ) const
+{
+	const size_t header_size = delimiter_header_size( expression );
+
+	return std::make_unique<Body_Chunks>( expression.substr(header_size), compiled_header(expression.substr(0, header_size)), m_default_delimiter_scanner, max_chunks, mp_scratch_resource );
+}
+
+
+Expression_Format Tokenizer::compile_format( std::string_view header ) const
+{
+	if( header.empty() )
+	{
+		return Expression_Format();
+	}
+
+	if( delimiter_header_size(header) != header.size() )
+	{
+		throw std::invalid_argument( "not a delimiter header: " + std::string(header) );
+	}
+
+	return Expression_Format( compiled_header(header) );
+}
+
+
+const Delimiter_Header_Cache & Tokenizer::header_cache() const
+{
+	return m_header_cache;
+}
+
+
+std::vector<std::string> Tokenizer::split( std::string_view expression, const std::string & delimiter ) const
 {
 	std::vector<std::string> tokens;
 
@@ -27,7 +214,6 @@ std::vector<std::string> Tokenizer::split( const std::string & expression, const
 		return tokens;
 	}
 
-	const size_t expression_size = expression.size();
 	const size_t delimiter_size = delimiter.size();
 
 	size_t start_pos = 0;
@@ -51,9 +237,99 @@ std::vector<std::string> Tokenizer::split( const std::string & expression, const
 }
 
 
-std::pair<std::set<std::string>, size_t> Tokenizer::parse_delimiter_header( const std::string & expression ) const
+// A header can only be parsed once its terminating newline has been read.
+// A "//[" header without "]\n" falls back on the static form, but that
+// cannot be known before the end of the input.
+bool Tokenizer::is_header_complete( std::string_view expression ) const
 {
-	std::set<std::string> delimiters {",", "\n"};
+	const std::string_view begin_tag( "//" );
+	const size_t shortest_header_size = 4;
+
+	if( expression.substr(0, begin_tag.size()) != begin_tag.substr(0, expression.size()) )
+	{
+		return true;
+	}
+
+	if( expression.size() < shortest_header_size )
+	{
+		return false;
+	}
+
+	return (expression[begin_tag.size()] != '[') || (expression.find("]\n") != std::string_view::npos);
+}
+
+
+// Mirrors parse_dynamic_delimiter_header() and parse_static_delimiter_header()
+// without building the delimiter set, so that the header bytes can be used
+// as a cache key.
+size_t Tokenizer::delimiter_header_size( std::string_view expression ) const
+{
+	const std::string_view dynamic_begin_tag( "//[" );
+	const std::string_view dynamic_end_tag( "]\n" );
+	const std::string_view static_begin_tag( "//" );
+	const size_t static_header_size = 4;
+
+	if( expression.substr(0, dynamic_begin_tag.size()) == dynamic_begin_tag )
+	{
+		const size_t end_tag_pos = expression.find( dynamic_end_tag );
+		if( end_tag_pos != std::string_view::npos )
+		{
+			return end_tag_pos + dynamic_end_tag.size();
+		}
+	}
+
+	if( (expression.substr(0, static_begin_tag.size()) == static_begin_tag) &&
+	    (expression.size() >= static_header_size) &&
+	    (expression[static_header_size - 1] == '\n') )
+	{
+		return static_header_size;
+	}
+
+	return 0;
+}
+
+
+// An empty header stands for the default delimiters.
+std::shared_ptr<const Delimiter_Header_Cache::Compiled_Header> Tokenizer::compiled_header( std::string_view header ) const
+{
+	if( header.empty() )
+	{
+		return mp_default_header;
+	}
+
+	return m_header_cache.find_or_compile( header, [this]( std::string_view header ){ return compile_header( header ); } );
+}
+
+
+std::shared_ptr<const Delimiter_Header_Cache::Compiled_Header> Tokenizer::compile_header( std::string_view header ) const
+{
+	const std::set<std::string> delimiters( parse_delimiter_header(header).first );
+	return std::make_shared<const Compiled_Header>( Compiled_Header{ Delimiter_Matcher(delimiters), delimiters == default_delimiters() } );
+}
+
+
+void Tokenizer::split_body( const Compiled_Header & header, std::string_view body, Token_Visitor_Interface & visitor ) const
+{
+	if( header.is_default_format )
+	{
+		m_default_delimiter_scanner.split( body, visitor );
+	}
+	else
+	{
+		header.matcher.split( body, visitor );
+	}
+}
+
+
+const std::set<std::string> & Tokenizer::default_delimiters() const
+{
+	return Expression_Format::default_delimiters();
+}
+
+
+std::pair<std::set<std::string>, size_t> Tokenizer::parse_delimiter_header( std::string_view expression ) const
+{
+	std::set<std::string> delimiters( default_delimiters() );
 	size_t header_size = 0;
 
 	parse_dynamic_delimiter_header( expression, delimiters, header_size ) ||
@@ -63,7 +339,7 @@ std::pair<std::set<std::string>, size_t> Tokenizer::parse_delimiter_header( cons
 }
 
 
-bool Tokenizer::parse_dynamic_delimiter_header( const std::string & expression, std::set<std::string> & delimiters, size_t & header_size ) const
+bool Tokenizer::parse_dynamic_delimiter_header( std::string_view expression, std::set<std::string> & delimiters, size_t & header_size ) const
 {
 	const std::string begin_tag( "//[" );
 	const std::string delimiter_delimiter( "][" );
@@ -74,7 +350,7 @@ bool Tokenizer::parse_dynamic_delimiter_header( const std::string & expression,
 	{
 		const auto end_tag_pos = expression.find( end_tag );
 		const size_t blob_length = end_tag_pos - begin_tag.size();
-		std::string blob( expression.substr(begin_tag.size(), blob_length) );
+		std::string_view blob( expression.substr(begin_tag.size(), blob_length) );
 		std::vector<std::string> custom_delimiters = split( blob, delimiter_delimiter);
 		for( const std::string & custom_delimiter : custom_delimiters )
 		{
@@ -92,7 +368,7 @@ bool Tokenizer::parse_dynamic_delimiter_header( const std::string & expression,
 }
 
 
-bool Tokenizer::parse_static_delimiter_header( const std::string & expression, std::set<std::string> & delimiters, size_t & header_size ) const
+bool Tokenizer::parse_static_delimiter_header( std::string_view expression, std::set<std::string> & delimiters, size_t & header_size ) const
 {
 	const std::string begin_tag( "//" );
 	const std::string end_tag( "\n" );
@@ -118,57 +394,7 @@ bool Tokenizer::parse_static_delimiter_header( const std::string & expression, s
 }
 
 
-std::string Tokenizer::replace_all( const std::string & in_this_str, const std::string & from_value, const std::string & to_value ) const
-{
-	std::string buffer( in_this_str );
-
-	auto pos = buffer.find( from_value );
-	while( pos != std::string::npos )
-	{
-		buffer.replace( pos, from_value.size(), to_value );
-		pos = buffer.find( from_value, pos+1 );
-	}
-
-	return buffer;
-}
-
-
-std::string Tokenizer::replace_all( const std::string & in_this_str, const std::set<std::string> & from_values, const std::string & to_value ) const
-{
-	std::vector<std::string> sorted_from_values( sort_longest_first(from_values) );
-
-	std::string buffer( in_this_str );
-
-	for( const std::string & from_value : sorted_from_values )
-	{
-		buffer = replace_all( buffer, from_value, "," );
-	}
-
-	return buffer;
-}
-
-
-std::vector<std::string> Tokenizer::sort_longest_first( const std::set<std::string> & unsorted ) const
-{
-	std::vector<std::string> sorted;
-
-	for( const std::string & str : unsorted )
-	{
-		sorted.push_back( str );
-	}
-
-	std::sort( sorted.begin(),
-	           sorted.end(),
-	           []( const std::string & a, const std::string & b ) { return a.size() > b.size(); }
-	);
-
-	return sorted;
-}
-
-
 std::string Tokenizer::ctos( char c ) const
 {
 	return std::string( 1, c );
 }
-
-
@@ -0,0 +1,269 @@
+#include "Work_Stealing_Executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+
+
+struct Work_Stealing_Executor::Job
+{
+	struct Range
+	{
+		size_t begin;
+		size_t end;
+	};
+
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Range> ranges;
+	};
+
+	Job( size_t count, const std::function<size_t(size_t)> & weight, const std::function<void(size_t)> & task, size_t worker_count ) :
+		task( task ),
+		cumulative_weights( count + 1, 0 ),
+		grain( 0 ),
+		queues( worker_count ),
+		remaining( count ),
+		exception_mutex(),
+		first_exception()
+	{
+		// Every item weighs at least one so that empty items are still split.
+		for( size_t i = 0; i < count; ++i )
+		{
+			cumulative_weights[i + 1] = cumulative_weights[i] + weight( i ) + 1;
+		}
+
+		const size_t total_weight = cumulative_weights.back();
+		grain = std::max<size_t>( 1, total_weight / (worker_count * 16) );
+
+		size_t begin = 0;
+		for( size_t worker = 0; worker < worker_count; ++worker )
+		{
+			const size_t end = ((worker + 1 == worker_count) || (begin == count)) ? count :
+				index_at_weight( begin, count, total_weight / worker_count * (worker + 1) );
+
+			if( end > begin )
+			{
+				queues[worker].ranges.push_back( Range{ begin, end } );
+			}
+			begin = end;
+		}
+	}
+
+	// First index in (begin, end] whose cumulative weight reaches target.
+	size_t index_at_weight( size_t begin, size_t end, size_t target ) const
+	{
+		const auto first = cumulative_weights.begin() + begin + 1;
+		const auto last = cumulative_weights.begin() + end;
+		return static_cast<size_t>( std::lower_bound(first, last, target) - cumulative_weights.begin() );
+	}
+
+	size_t weight_of( const Range & range ) const
+	{
+		return cumulative_weights[range.end] - cumulative_weights[range.begin];
+	}
+
+	bool pop( size_t worker, Range & range )
+	{
+		Queue & queue = queues[worker];
+		std::lock_guard<std::mutex> lock( queue.mutex );
+
+		if( queue.ranges.empty() )
+		{
+			return false;
+		}
+
+		range = queue.ranges.back();
+		queue.ranges.pop_back();
+		return true;
+	}
+
+	bool steal( size_t thief, Range & range )
+	{
+		for( size_t offset = 1; offset < queues.size(); ++offset )
+		{
+			Queue & queue = queues[(thief + offset) % queues.size()];
+			std::lock_guard<std::mutex> lock( queue.mutex );
+
+			if( !queue.ranges.empty() )
+			{
+				range = queue.ranges.front();
+				queue.ranges.pop_front();
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void push( size_t worker, const Range & range )
+	{
+		Queue & queue = queues[worker];
+		std::lock_guard<std::mutex> lock( queue.mutex );
+		queue.ranges.push_back( range );
+	}
+
+	void run( const Range & range )
+	{
+		for( size_t i = range.begin; i < range.end; ++i )
+		{
+			try
+			{
+				task( i );
+			}
+			catch( ... )
+			{
+				std::lock_guard<std::mutex> lock( exception_mutex );
+				if( !first_exception )
+				{
+					first_exception = std::current_exception();
+				}
+			}
+		}
+
+		remaining.fetch_sub( range.end - range.begin );
+	}
+
+	const std::function<void(size_t)> & task;
+	std::vector<size_t> cumulative_weights;
+	size_t grain;
+	std::vector<Queue> queues;
+	std::atomic<size_t> remaining;
+	std::mutex exception_mutex;
+	std::exception_ptr first_exception;
+};
+
+
+Work_Stealing_Executor::Work_Stealing_Executor( size_t thread_count ) :
+	m_threads(),
+	m_for_each_mutex(),
+	m_mutex(),
+	m_job_posted(),
+	m_job_finished(),
+	mp_job( nullptr ),
+	m_generation( 0 ),
+	m_busy_workers( 0 ),
+	m_stopping( false )
+{
+	for( size_t worker = 1; worker < thread_count; ++worker )
+	{
+		m_threads.emplace_back( &Work_Stealing_Executor::worker_loop, this, worker );
+	}
+}
+
+
+Work_Stealing_Executor::~Work_Stealing_Executor()
+{
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_stopping = true;
+	}
+	m_job_posted.notify_all();
+
+	for( std::thread & thread : m_threads )
+	{
+		thread.join();
+	}
+}
+
+
+void Work_Stealing_Executor::for_each( size_t count, const std::function<size_t(size_t)> & weight, const std::function<void(size_t)> & task )
+{
+	if( count == 0 )
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> for_each_lock( m_for_each_mutex );
+
+	Job job( count, weight, task, thread_count() );
+
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		mp_job = &job;
+		++m_generation;
+		m_busy_workers = m_threads.size();
+	}
+	m_job_posted.notify_all();
+
+	run_worker( 0, job );
+
+	{
+		std::unique_lock<std::mutex> lock( m_mutex );
+		m_job_finished.wait( lock, [this]{ return m_busy_workers == 0; } );
+		mp_job = nullptr;
+	}
+
+	if( job.first_exception )
+	{
+		std::rethrow_exception( job.first_exception );
+	}
+}
+
+
+size_t Work_Stealing_Executor::thread_count() const
+{
+	return m_threads.size() + 1;
+}
+
+
+void Work_Stealing_Executor::worker_loop( size_t worker )
+{
+	size_t seen_generation = 0;
+
+	while( true )
+	{
+		Job * p_job = nullptr;
+
+		{
+			std::unique_lock<std::mutex> lock( m_mutex );
+			m_job_posted.wait( lock, [&]{ return m_stopping || (m_generation != seen_generation); } );
+
+			if( m_stopping )
+			{
+				return;
+			}
+
+			seen_generation = m_generation;
+			p_job = mp_job;
+		}
+
+		run_worker( worker, *p_job );
+
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			--m_busy_workers;
+		}
+		m_job_finished.notify_one();
+	}
+}
+
+
+void Work_Stealing_Executor::run_worker( size_t worker, Job & job )
+{
+	Job::Range range { 0, 0 };
+
+	while( job.remaining.load() > 0 )
+	{
+		if( !job.pop(worker, range) && !job.steal(worker, range) )
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Keep the first half and leave the rest where other workers can
+		// steal it, until what is left is cheap enough to run in one go.
+		while( ((range.end - range.begin) > 1) && (job.weight_of(range) > job.grain) )
+		{
+			const size_t half_weight = job.cumulative_weights[range.begin] + (job.weight_of(range) + 1) / 2;
+			const size_t middle = std::clamp( job.index_at_weight(range.begin, range.end, half_weight), range.begin + 1, range.end - 1 );
+
+			job.push( worker, Job::Range{ middle, range.end } );
+			range.end = middle;
+		}
+
+		job.run( range );
+	}
+}
@@ -1,9 +1,26 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
 #include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
 #include "gmock/gmock.h"
 
 #include "String_Calculator.h"
 #include "Add_Observer_Interface.h"
 #include "Tokenizer.h"
+#include "Dispatching_Tokenizer.h"
+#include "Work_Stealing_Executor.h"
+#include "Expression_Format.h"
+#include "Temporary_File.h"
+#include "Counting_Memory_Resource.h"
+#include "Add_Result_Cache.h"
+#include "Mapped_Add_Result_Cache.h"
+#include "Global_New_Counter.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace testing;
 
@@ -385,3 +402,414 @@ TEST(AcceptanceTestDelimiters, AZCommaAsMultipleDynamicallyDeclaredDelimiters)
 	EXPECT_EQ( 6, add("//[AZ,]\n1AZ,2AZ,3") );
 }
 
+
+TEST(AcceptanceTestAddIgnoresNumbersOverOneThousand, HugeNumbersAreIgnoredWithoutError)
+{
+	EXPECT_EQ( 3, add("1,99999999999,2") );
+	EXPECT_EQ( 5, add("//[***]\n5***123456789012345678901234567890") );
+}
+
+TEST(AcceptanceTestAddBatch, MatchesAddForEachExpression)
+{
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+
+	const std::string expressions[] = { "", "1,2", "//;\n1;2", "//[***]\n1***2***3", "2,1001", "1,-2,-4,8" };
+	int results[6];
+	std::string error_messages[6];
+
+	calculator.add_batch( expressions, 6, results, error_messages );
+
+	EXPECT_THAT( results, ElementsAre(0, 3, 3, 6, 2, 0) );
+	EXPECT_EQ( "negatives not allowed: -2 -4", error_messages[5] );
+	EXPECT_EQ( 6, calculator.get_called_count() );
+}
+
+TEST(AcceptanceTestAddBatch, ParallelBatchMatchesSerialBatch)
+{
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+	Work_Stealing_Executor executor( 4 );
+
+	std::vector<std::string> expressions;
+	for( int i = 0; i < 2000; ++i )
+	{
+		expressions.push_back( (i % 7 == 0) ? "//[***]\n" + std::to_string(i) + "***-" + std::to_string(i + 1) :
+		                       (i % 101 == 0) ? std::string(100000, '1') :
+		                       std::to_string(i) + "," + std::to_string(i % 13) + "\n5" );
+	}
+
+	std::vector<int> serial_results( expressions.size() );
+	std::vector<std::string> serial_error_messages( expressions.size() );
+	calculator.add_batch( expressions.data(), expressions.size(), serial_results.data(), serial_error_messages.data() );
+
+	std::vector<int> parallel_results( expressions.size() );
+	std::vector<std::string> parallel_error_messages( expressions.size() );
+	calculator.add_batch( expressions.data(), expressions.size(), parallel_results.data(), parallel_error_messages.data(), executor );
+
+	EXPECT_EQ( serial_results, parallel_results );
+	EXPECT_EQ( serial_error_messages, parallel_error_messages );
+}
+
+static std::string huge_expression( const std::string & header, const std::string & delimiter, int count, int negative_every )
+{
+	std::string expression( header );
+	for( int i = 1; i <= count; ++i )
+	{
+		expression += std::to_string( (i % negative_every == 0) ? -i : (i % 1500) ) + delimiter;
+	}
+	return expression;
+}
+
+static void test_add_with_executor_matches_add( const std::string & expression )
+{
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+	Work_Stealing_Executor executor( 4 );
+
+	std::string serial_message;
+	std::string parallel_message;
+	int serial_result = -1;
+	int parallel_result = -1;
+
+	try
+	{
+		serial_result = calculator.add( expression );
+	}
+	catch( const std::exception & e )
+	{
+		serial_message = e.what();
+	}
+
+	try
+	{
+		parallel_result = calculator.add( expression, executor );
+	}
+	catch( const std::exception & e )
+	{
+		parallel_message = e.what();
+	}
+
+	EXPECT_EQ( serial_result, parallel_result );
+	EXPECT_EQ( serial_message, parallel_message );
+}
+
+TEST(AcceptanceTestAddWithExecutor, MatchesAddOnHugeExpressions)
+{
+	test_add_with_executor_matches_add( huge_expression("", "\n", 200000, 1000000) );
+	test_add_with_executor_matches_add( huge_expression("", ",", 200000, 9973) );
+	test_add_with_executor_matches_add( huge_expression("//[***]\n", "***", 200000, 1000000) );
+	test_add_with_executor_matches_add( huge_expression("//[***][*]\n", "***", 200000, 7919) );
+	test_add_with_executor_matches_add( huge_expression("//;\n", ";", 200000, 1000000) + "x;1" );
+}
+
+static int add_streamed( const std::string & str )
+{
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+	std::istringstream input( str );
+	return calculator.add( input );
+}
+
+TEST(AcceptanceTestAddFromStream, MatchesAdd)
+{
+	EXPECT_EQ( 0, add_streamed("") );
+	EXPECT_EQ( 3, add_streamed("1,2") );
+	EXPECT_EQ( 6, add_streamed("1\n2,3") );
+	EXPECT_EQ( 3, add_streamed("//;\n1;2") );
+	EXPECT_EQ( 6, add_streamed("//[***]\n1***2***3") );
+	EXPECT_EQ( 2, add_streamed("2,1001") );
+	EXPECT_THROW( add_streamed("1,x"), std::invalid_argument );
+}
+
+TEST(AcceptanceTestAddFromStream, ReportsNegativesAcrossChunks)
+{
+	const std::string expression( huge_expression("//[***]\n", "***", 200000, 9973) );
+
+	std::string expected_message;
+	try
+	{
+		add( expression );
+	}
+	catch( const std::exception & e )
+	{
+		expected_message = e.what();
+	}
+
+	try
+	{
+		add_streamed( expression );
+		FAIL() << "Expected exception";
+	}
+	catch( const std::exception & e )
+	{
+		EXPECT_EQ( expected_message, e.what() );
+	}
+}
+
+TEST(AcceptanceTestAddFromStream, ReadsFromFileDescriptor)
+{
+	const std::string expression( huge_expression("//[*][%%]\n", "%%", 100000, 1000000) );
+
+	FILE * p_file = std::tmpfile();
+	ASSERT_NE( nullptr, p_file );
+	std::fwrite( expression.data(), 1, expression.size(), p_file );
+	std::fflush( p_file );
+	lseek( fileno(p_file), 0, SEEK_SET );
+
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+	EXPECT_EQ( add(expression), calculator.add_fd(fileno(p_file)) );
+
+	std::fclose( p_file );
+}
+
+static int add_file( const std::string & str )
+{
+	Temporary_File file( str );
+
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+	return calculator.add_file( file.path );
+}
+
+TEST(AcceptanceTestAddFile, MatchesAdd)
+{
+	EXPECT_EQ( 0, add_file("") );
+	EXPECT_EQ( 3, add_file("1,2") );
+	EXPECT_EQ( 3, add_file("//;\n1;2") );
+	EXPECT_EQ( 6, add_file("//[***]\n1***2***3") );
+	EXPECT_EQ( 2, add_file("2,1001") );
+	EXPECT_THROW( add_file("1,-2"), std::invalid_argument );
+
+	const std::string expression( huge_expression("//[*][%%]\n", "%%", 100000, 1000000) );
+	EXPECT_EQ( add(expression), add_file(expression) );
+}
+
+TEST(AcceptanceTestAddFile, ReadsFilesThatCannotBeMapped)
+{
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+
+	std::string fifo_path( "/tmp/string-calculator-fifo-XXXXXX" );
+	ASSERT_NE( nullptr, ::mkdtemp(&fifo_path[0]) );
+	const std::string directory( fifo_path );
+	fifo_path += "/fifo";
+	ASSERT_EQ( 0, ::mkfifo(fifo_path.c_str(), 0600) );
+
+	std::thread writer( [&fifo_path]{ std::ofstream( fifo_path ) << "//;\n1;2\n3"; } );
+	EXPECT_EQ( 6, calculator.add_file(fifo_path) );
+	writer.join();
+
+	::unlink( fifo_path.c_str() );
+	::rmdir( directory.c_str() );
+
+	// Files under /proc report a size of zero whatever they hold.
+	const std::string proc_path( "/proc/sys/kernel/randomize_va_space" );
+	std::ifstream proc_file( proc_path );
+	const std::string contents( (std::istreambuf_iterator<char>(proc_file)), std::istreambuf_iterator<char>() );
+	if( !contents.empty() )
+	{
+		EXPECT_EQ( calculator.add(contents), calculator.add_file(proc_path) );
+	}
+}
+
+TEST(AcceptanceTestAddFile, ThrowsWhenFileIsMissing)
+{
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+	EXPECT_THROW( calculator.add_file("/nonexistent/string-calculator-input"), std::system_error );
+}
+
+TEST(AcceptanceTestAddWithFormat, MatchesAddWithHeader)
+{
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+
+	const Expression_Format format( tokenizer.compile_format("//[***][%%]\n") );
+
+	EXPECT_EQ( calculator.add("//[***][%%]\n1***2%%3,4"), calculator.add("1***2%%3,4", format) );
+	EXPECT_EQ( 2, calculator.add("2***1001", format) );
+	EXPECT_EQ( 0, calculator.add("", format) );
+	EXPECT_THROW( calculator.add("1***-2", format), std::invalid_argument );
+	EXPECT_EQ( 6, calculator.add("1,2\n3", Expression_Format()) );
+}
+
+TEST(AcceptanceTestDispatchingTokenizer, MatchesTokenizer)
+{
+	Dispatching_Tokenizer tokenizer;
+	tokenizer.register_format<>();
+	tokenizer.register_format<';'>();
+	String_Calculator calculator( tokenizer );
+
+	EXPECT_EQ( 6, calculator.add("1,2\n3") );
+	EXPECT_EQ( 3, calculator.add("//;\n1;2") );
+	EXPECT_EQ( 6, calculator.add("//[***]\n1***2***3") );
+	EXPECT_EQ( 2, calculator.add("//;\n2;1001") );
+	EXPECT_THROW( calculator.add("//;\n1;-2"), std::invalid_argument );
+}
+
+TEST(AcceptanceTestScratchMemory, AddMakesNoGlobalAllocationsOnceWarm)
+{
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+	const std::string expressions[] = { "", "1,2\n3", "//;\n1;2;1001", "//[***][%%]\n1***2%%3" };
+	int results[4] = {};
+	std::string error_messages[4];
+
+	// The first pass compiles and caches the headers.
+	calculator.add_batch( expressions, 4, results, error_messages );
+
+	const size_t new_count_before = global_new_count();
+	for( int pass = 0; pass < 100; ++pass )
+	{
+		for( const std::string & expression : expressions )
+		{
+			calculator.add( expression );
+		}
+		calculator.add_batch( expressions, 4, results, error_messages );
+	}
+
+	EXPECT_EQ( new_count_before, global_new_count() );
+}
+
+TEST(AcceptanceTestScratchMemory, ScratchOutgrowingTheArenaComesFromGivenResource)
+{
+	Counting_Memory_Resource resource;
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer, &resource );
+
+	calculator.add( "1,2,3" );
+	EXPECT_EQ( 0u, resource.allocation_count );
+
+	const std::string negatives = huge_expression( "", ",", 10000, 1 );
+	std::string error_message;
+	int result = 0;
+	calculator.add_batch( &negatives, 1, &result, &error_message );
+
+	EXPECT_LT( 0u, resource.allocation_count );
+	EXPECT_EQ( 0, result );
+	EXPECT_NE( std::string::npos, error_message.find("negatives not allowed") );
+}
+
+TEST(AcceptanceTestTryAdd, ReturnsSumAndNotifies)
+{
+	Tokenizer tokenizer;
+	Mock_Add_Observer observer;
+	String_Calculator calculator( tokenizer, observer );
+
+	const Add_Result result = calculator.try_add( "//;\n1;2;1001" );
+
+	ASSERT_TRUE( result.has_value() );
+	EXPECT_EQ( 3, result.value() );
+	EXPECT_EQ( 1, observer.call_count );
+	EXPECT_EQ( 1, calculator.get_called_count() );
+}
+
+TEST(AcceptanceTestTryAdd, ReportsNegativesAndWhereTheyAre)
+{
+	Tokenizer tokenizer;
+	Mock_Add_Observer observer;
+	String_Calculator calculator( tokenizer, observer );
+
+	const std::string expression( "//[***]\n1***-2***3,-40" );
+	const Add_Result result = calculator.try_add( expression );
+
+	ASSERT_FALSE( result.has_value() );
+	const Add_Error & error = result.error();
+	EXPECT_EQ( Add_Error::Kind::negative_numbers, error.kind() );
+	ASSERT_EQ( 2u, error.negative_numbers().size() );
+	EXPECT_EQ( -2, error.negative_numbers()[0].value );
+	EXPECT_EQ( expression.find("-2"), error.negative_numbers()[0].position );
+	EXPECT_EQ( -40, error.negative_numbers()[1].value );
+	EXPECT_EQ( expression.find("-40"), error.negative_numbers()[1].position );
+	EXPECT_EQ( 0, observer.call_count );
+
+	try
+	{
+		calculator.add( expression );
+		FAIL();
+	}
+	catch( const std::invalid_argument & e )
+	{
+		EXPECT_EQ( e.what(), error.message() );
+	}
+}
+
+TEST(AcceptanceTestTryAdd, CapsReportedNegatives)
+{
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+
+	const Add_Result result = calculator.try_add( "-1,-2,-3,-4", 2 );
+
+	ASSERT_FALSE( result.has_value() );
+	EXPECT_EQ( 2u, result.error().negative_numbers().size() );
+	EXPECT_EQ( 4u, result.error().negative_number_count() );
+	EXPECT_EQ( "negatives not allowed: -1 -2 ...", result.error().message() );
+}
+
+TEST(AcceptanceTestTryAdd, ReportsBadTokens)
+{
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+
+	EXPECT_EQ( Add_Error::Kind::invalid_number, calculator.try_add("1,x").error().kind() );
+	EXPECT_EQ( Add_Error::Kind::number_out_of_range, calculator.try_add("-99999999999").error().kind() );
+}
+
+TEST(AcceptanceTestResultCache, CachedResultsMatchAndStillNotify)
+{
+	Tokenizer tokenizer;
+	Mock_Add_Observer observer;
+	String_Calculator calculator( tokenizer, observer );
+	Add_Result_Cache cache( 64 );
+	calculator.set_result_cache( &cache );
+
+	EXPECT_EQ( 6, calculator.add("//;\n1;2;3") );
+	EXPECT_EQ( 6, calculator.add("//;\n1;2;3") );
+	EXPECT_EQ( 2, observer.call_count );
+	EXPECT_EQ( 6, observer.result );
+	EXPECT_EQ( 2, calculator.get_called_count() );
+	EXPECT_EQ( 1u, cache.hit_count() );
+
+	for( int pass = 0; pass < 2; ++pass )
+	{
+		try
+		{
+			calculator.add( "1,-2,-3" );
+			FAIL();
+		}
+		catch( const std::invalid_argument & e )
+		{
+			EXPECT_STREQ( "negatives not allowed: -2 -3", e.what() );
+		}
+	}
+	EXPECT_EQ( 2u, cache.hit_count() );
+	EXPECT_EQ( 2, observer.call_count );
+
+	EXPECT_THROW( calculator.add("1,x"), std::invalid_argument );
+	EXPECT_THROW( calculator.add("1,x"), std::invalid_argument );
+}
+
+TEST(AcceptanceTestResultCache, MappedCacheServesHitsAfterRestart)
+{
+	const Temporary_File file( "" );
+	Tokenizer tokenizer;
+
+	{
+		String_Calculator calculator( tokenizer );
+		Mapped_Add_Result_Cache cache( file.path, 64 );
+		calculator.set_result_cache( &cache );
+		EXPECT_EQ( 6, calculator.add("1,2,3") );
+	}
+
+	Mock_Add_Observer observer;
+	String_Calculator calculator( tokenizer, observer );
+	Mapped_Add_Result_Cache cache( file.path, 64 );
+	calculator.set_result_cache( &cache );
+
+	EXPECT_EQ( 6, calculator.add("1,2,3") );
+	EXPECT_EQ( 1u, cache.hit_count() );
+	EXPECT_EQ( 1, observer.call_count );
+}
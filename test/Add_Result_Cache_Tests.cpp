@@ -0,0 +1,126 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "Add_Result_Cache.h"
+
+static Add_Result_Cache::Entry empty_entry()
+{
+	return Add_Result_Cache::Entry{ false, -1, std::string() };
+}
+
+TEST(AddResultCache, FindsStoredTotals)
+{
+	Add_Result_Cache cache( 16 );
+	Add_Result_Cache::Entry entry = empty_entry();
+
+	EXPECT_FALSE( cache.find("1,2", entry) );
+
+	cache.store_total( "1,2", 3 );
+
+	ASSERT_TRUE( cache.find("1,2", entry) );
+	EXPECT_FALSE( entry.has_negative_numbers );
+	EXPECT_EQ( 3, entry.total );
+	EXPECT_FALSE( cache.find("1,2,", entry) );
+}
+
+TEST(AddResultCache, FindsStoredNegatives)
+{
+	Add_Result_Cache cache( 16 );
+	Add_Result_Cache::Entry entry = empty_entry();
+
+	cache.store_negative_numbers( "1,-2", "negatives not allowed: -2" );
+
+	ASSERT_TRUE( cache.find("1,-2", entry) );
+	EXPECT_TRUE( entry.has_negative_numbers );
+	EXPECT_EQ( "negatives not allowed: -2", entry.negative_numbers_message );
+}
+
+TEST(AddResultCache, DoesNotCacheExpressionsOverMaxSize)
+{
+	Add_Result_Cache cache( 16, Add_Result_Cache::default_slots_per_shard, 3 );
+	Add_Result_Cache::Entry entry = empty_entry();
+
+	cache.store_total( "1,2", 3 );
+	cache.store_total( "1,22", 23 );
+
+	EXPECT_EQ( 3u, cache.max_expression_size() );
+	EXPECT_TRUE( cache.find("1,2", entry) );
+	EXPECT_FALSE( cache.find("1,22", entry) );
+}
+
+TEST(AddResultCache, CountsHitsAndMisses)
+{
+	Add_Result_Cache cache( 16 );
+	Add_Result_Cache::Entry entry = empty_entry();
+
+	EXPECT_EQ( 0.0, cache.hit_rate() );
+
+	cache.find( "1", entry );
+	cache.store_total( "1", 1 );
+	cache.find( "1", entry );
+	cache.find( "1", entry );
+	cache.find( "2", entry );
+
+	EXPECT_EQ( 2u, cache.hit_count() );
+	EXPECT_EQ( 2u, cache.miss_count() );
+	EXPECT_DOUBLE_EQ( 0.5, cache.hit_rate() );
+}
+
+TEST(AddResultCache, RoundsCapacityUpToWholeShards)
+{
+	EXPECT_EQ( 8u, Add_Result_Cache(1).capacity() );
+	EXPECT_EQ( 32u, Add_Result_Cache(17).capacity() );
+	EXPECT_EQ( 12u, Add_Result_Cache(10, 3).capacity() );
+}
+
+TEST(AddResultCache, GivesRecentlyHitSlotsASecondChance)
+{
+	Add_Result_Cache cache( 3, 3 );
+	Add_Result_Cache::Entry entry = empty_entry();
+
+	cache.store_total( "1", 1 );
+	cache.store_total( "2", 2 );
+	cache.store_total( "3", 3 );
+	cache.find( "1", entry );
+	cache.store_total( "4", 4 );
+
+	EXPECT_TRUE( cache.find("1", entry) );
+	EXPECT_FALSE( cache.find("2", entry) );
+	EXPECT_TRUE( cache.find("3", entry) );
+	EXPECT_TRUE( cache.find("4", entry) );
+}
+
+TEST(AddResultCache, CanBeSharedBetweenThreads)
+{
+	Add_Result_Cache cache( 64 );
+
+	std::vector<std::thread> threads;
+	for( int t = 0; t < 4; ++t )
+	{
+		threads.emplace_back( [&cache]
+			{
+				Add_Result_Cache::Entry entry = empty_entry();
+				for( int i = 0; i < 2000; ++i )
+				{
+					const std::string expression( std::to_string(i % 100) );
+					if( cache.find(expression, entry) )
+					{
+						EXPECT_EQ( i % 100, entry.total );
+					}
+					else
+					{
+						cache.store_total( expression, i % 100 );
+					}
+				}
+			} );
+	}
+	for( std::thread & thread : threads )
+	{
+		thread.join();
+	}
+
+	EXPECT_EQ( 8000u, cache.hit_count() + cache.miss_count() );
+}
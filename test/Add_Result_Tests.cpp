@@ -0,0 +1,46 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "Add_Result.h"
+
+TEST(AddResult, HoldsValue)
+{
+	const Add_Result result( 6 );
+
+	EXPECT_TRUE( result.has_value() );
+	EXPECT_TRUE( static_cast<bool>(result) );
+	EXPECT_EQ( 6, result.value() );
+	EXPECT_THROW( result.error(), std::logic_error );
+}
+
+TEST(AddResult, HoldsError)
+{
+	const Add_Result result( Add_Error(Add_Error::Kind::invalid_number, "stoi") );
+
+	EXPECT_FALSE( result.has_value() );
+	EXPECT_FALSE( static_cast<bool>(result) );
+	EXPECT_THROW( result.value(), std::logic_error );
+	EXPECT_EQ( Add_Error::Kind::invalid_number, result.error().kind() );
+	EXPECT_EQ( "stoi", result.error().message() );
+}
+
+TEST(AddError, MessageListsNegatives)
+{
+	const Add_Error error( { Negative_Number{ -2, 2 }, Negative_Number{ -4, 5 } }, 2 );
+
+	EXPECT_EQ( Add_Error::Kind::negative_numbers, error.kind() );
+	EXPECT_EQ( 2u, error.negative_number_count() );
+	EXPECT_EQ( "negatives not allowed: -2 -4", error.message() );
+}
+
+TEST(AddError, MessageMarksNegativesLeftOut)
+{
+	const Add_Error error( { Negative_Number{ -2, 2 } }, 3 );
+
+	EXPECT_EQ( 1u, error.negative_numbers().size() );
+	EXPECT_EQ( 3u, error.negative_number_count() );
+	EXPECT_EQ( "negatives not allowed: -2 ...", error.message() );
+}
@@ -0,0 +1,105 @@
+#include <stdexcept>
+#include <string>
+
+#include "gmock/gmock.h"
+
+#include "Add_Session.h"
+#include "String_Calculator.h"
+#include "Tokenizer.h"
+
+// What add() returns or throws, as text that can be compared.
+template<typename Function>
+static std::string outcome_of( Function function )
+{
+	try
+	{
+		return "total " + std::to_string( function() );
+	}
+	catch( const std::exception & e )
+	{
+		return std::string( "error " ) + e.what();
+	}
+}
+
+static void test_session_matches_add( const std::string & expression, size_t fragment_size )
+{
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+	Add_Session session( tokenizer );
+
+	for( size_t end = fragment_size; end < expression.size() + fragment_size; end += fragment_size )
+	{
+		const size_t begin = end - fragment_size;
+		const std::string prefix = expression.substr( 0, end );
+
+		EXPECT_EQ( outcome_of([&]{ return calculator.add(prefix); }), outcome_of([&]{ return session.append(expression.substr(begin, fragment_size)); }) )
+			<< "after \"" << prefix << "\" appended " << fragment_size << " bytes at a time";
+	}
+}
+
+static void test_session_matches_add( const std::string & expression )
+{
+	for( size_t fragment_size = 1; fragment_size <= 5; ++fragment_size )
+	{
+		test_session_matches_add( expression, fragment_size );
+	}
+}
+
+TEST(AddSession, MatchesAddAfterEveryFragment)
+{
+	test_session_matches_add( "1\n22,333,,4444,5" );
+	test_session_matches_add( "//;\n1;22;;333;1001;4" );
+	test_session_matches_add( "//[***]\n1***22******333***4" );
+	test_session_matches_add( "//[*][**][***]\n1*2**3***4****5*****6" );
+	test_session_matches_add( "//[,**]\n1,**2,3,**4,,**5" );
+	test_session_matches_add( "//[\n1[2[3" );
+	test_session_matches_add( "//[]\n1,2,3" );
+}
+
+// No cut is safe with these delimiters, so every append sums the whole
+// body again.
+TEST(AddSession, MatchesAddWhenDelimitersAreNotSinglePass)
+{
+	test_session_matches_add( "//[xyz][wx]\n1wxyz2xyz3wx4wxyz5" );
+	test_session_matches_add( "//[ab][bcd]\n1abcd2ab3bcd4abcd-5" );
+	test_session_matches_add( "//[;,][;]\n1;,2;3;;,4" );
+}
+
+TEST(AddSession, MatchesAddWithNegatives)
+{
+	test_session_matches_add( "1,-2,3,-44,5" );
+	test_session_matches_add( "//[--]\n1---2--3" );
+}
+
+TEST(AddSession, MatchesAddWithBadTokens)
+{
+	test_session_matches_add( "1,2,x,3" );
+	test_session_matches_add( "1,99999999999,3" );
+}
+
+TEST(AddSession, EmptyFragmentKeepsTotal)
+{
+	Tokenizer tokenizer;
+	Add_Session session( tokenizer );
+
+	EXPECT_EQ( 0, session.append("") );
+	EXPECT_EQ( 12, session.append("1,11") );
+	EXPECT_EQ( 12, session.append("") );
+}
+
+TEST(AddSession, WithOverflowCheckingThrowsOnceTotalIsTooLargeForInt)
+{
+	// Together just enough thousands to go past INT_MAX.
+	std::string half;
+	for( int i = 0; i < 2147484 / 2; ++i )
+	{
+		half += "1000,";
+	}
+
+	Tokenizer tokenizer;
+	Add_Session session( tokenizer );
+	session.set_overflow_checking( true );
+
+	EXPECT_EQ( 1073742000, session.append(half) );
+	EXPECT_THROW( session.append(half), std::overflow_error );
+}
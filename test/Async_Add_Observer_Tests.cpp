@@ -0,0 +1,227 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "Async_Add_Observer.h"
+#include "Mock_Add_Observer.h"
+
+using namespace testing;
+
+class Recording_Observer : public Add_Observer_Interface
+{
+	public:
+
+		Recording_Observer( bool wants_expressions = true ) :
+			m_wants_expressions( wants_expressions )
+		{
+		}
+
+		void add_occurred( const std::string & expression, int result ) override
+		{
+			expressions.push_back( expression );
+			results.push_back( result );
+		}
+
+		bool needs_expression() const override
+		{
+			return m_wants_expressions;
+		}
+
+		std::vector<std::string> expressions;
+		std::vector<int> results;
+
+	private:
+
+		const bool m_wants_expressions;
+};
+
+// Holds up the background thread until released.
+class Gated_Observer : public Add_Observer_Interface
+{
+	public:
+
+		Gated_Observer() :
+			open( false ),
+			call_count( 0 )
+		{
+		}
+
+		void add_occurred( const std::string &, int ) override
+		{
+			while( !open.load() )
+			{
+				std::this_thread::yield();
+			}
+			++call_count;
+		}
+
+		std::atomic<bool> open;
+		std::atomic<int> call_count;
+};
+
+TEST(AsyncAddObserver, CapacityIsRoundedUpToPowerOfTwo)
+{
+	Mock_Add_Observer observer;
+	EXPECT_EQ( 8u, Async_Add_Observer(observer, 5).capacity() );
+	EXPECT_EQ( 1u, Async_Add_Observer(observer, 0).capacity() );
+}
+
+TEST(AsyncAddObserver, DeliversEventsInOrder)
+{
+	Recording_Observer observer;
+	Async_Add_Observer async_observer( observer, 4, Async_Add_Observer::Overflow_Policy::block );
+
+	for( int i = 0; i < 100; ++i )
+	{
+		async_observer.add_occurred( std::to_string(i), i );
+	}
+	async_observer.flush();
+
+	ASSERT_EQ( 100u, observer.results.size() );
+	for( int i = 0; i < 100; ++i )
+	{
+		EXPECT_EQ( std::to_string(i), observer.expressions[i] );
+		EXPECT_EQ( i, observer.results[i] );
+	}
+	EXPECT_EQ( 100u, async_observer.delivered_count() );
+	EXPECT_EQ( 0u, async_observer.dropped_count() );
+}
+
+TEST(AsyncAddObserver, SkipsExpressionWhenObserverOnlyWantsMetadata)
+{
+	Recording_Observer observer( false );
+	Async_Add_Observer async_observer( observer, 4 );
+
+	async_observer.add_occurred( "1,2", 3 );
+	async_observer.flush();
+
+	EXPECT_THAT( observer.expressions, ElementsAre("") );
+	EXPECT_THAT( observer.results, ElementsAre(3) );
+}
+
+TEST(AsyncAddObserver, WakesUpForEventsAfterFallingIdle)
+{
+	Recording_Observer observer;
+	Async_Add_Observer async_observer( observer, 4 );
+
+	for( int i = 0; i < 3; ++i )
+	{
+		std::this_thread::sleep_for( std::chrono::milliseconds(5) );
+		async_observer.add_occurred( std::to_string(i), i );
+		async_observer.flush();
+	}
+
+	EXPECT_THAT( observer.results, ElementsAre(0, 1, 2) );
+}
+
+TEST(AsyncAddObserver, DropPolicyCountsDiscardedEvents)
+{
+	Gated_Observer observer;
+	Async_Add_Observer async_observer( observer, 4, Async_Add_Observer::Overflow_Policy::drop );
+
+	for( int i = 0; i < 20; ++i )
+	{
+		async_observer.add_occurred( "", i );
+	}
+
+	observer.open = true;
+	async_observer.flush();
+
+	// At most one event in the observer plus a full buffer get through.
+	EXPECT_GE( async_observer.dropped_count(), 15u );
+	EXPECT_EQ( 20u, async_observer.dropped_count() + async_observer.delivered_count() );
+}
+
+TEST(AsyncAddObserver, SamplePolicyLetsEveryNthOverflowingEventThrough)
+{
+	Gated_Observer observer;
+	Async_Add_Observer async_observer( observer, 4, Async_Add_Observer::Overflow_Policy::sample, 5 );
+
+	std::thread producer( [&]
+		{
+			for( int i = 0; i < 20; ++i )
+			{
+				async_observer.add_occurred( "", i );
+			}
+		} );
+
+	// The fifth overflowing event waits for room, so four are dropped
+	// before the producer blocks.
+	while( async_observer.dropped_count() < 4 )
+	{
+		std::this_thread::yield();
+	}
+	observer.open = true;
+	producer.join();
+	async_observer.flush();
+
+	EXPECT_EQ( 20u, async_observer.dropped_count() + async_observer.delivered_count() );
+	EXPECT_GE( async_observer.delivered_count(), 5u );
+}
+
+TEST(AsyncAddObserver, AcceptsEventsFromManyThreads)
+{
+	Recording_Observer observer;
+	Async_Add_Observer async_observer( observer, 64, Async_Add_Observer::Overflow_Policy::block );
+
+	std::vector<std::thread> producers;
+	for( int t = 0; t < 4; ++t )
+	{
+		producers.emplace_back( [&async_observer]
+			{
+				for( int i = 0; i < 1000; ++i )
+				{
+					async_observer.add_occurred( "1", 1 );
+				}
+			} );
+	}
+	for( std::thread & producer : producers )
+	{
+		producer.join();
+	}
+	async_observer.flush();
+
+	EXPECT_EQ( 4000u, observer.results.size() );
+	EXPECT_EQ( 0u, async_observer.dropped_count() );
+}
+
+// Throws for every odd result.
+class Throwing_Observer : public Recording_Observer
+{
+	public:
+
+		void add_occurred( const std::string & expression, int result ) override
+		{
+			if( result % 2 != 0 )
+			{
+				throw std::runtime_error( "observer failed" );
+			}
+
+			Recording_Observer::add_occurred( expression, result );
+		}
+};
+
+TEST(AsyncAddObserver, CountsAndDropsExceptionsFromObserver)
+{
+	Throwing_Observer observer;
+
+	{
+		Async_Add_Observer async_observer( observer, 8, Async_Add_Observer::Overflow_Policy::block );
+
+		for( int i = 0; i < 6; ++i )
+		{
+			async_observer.add_occurred( "", i );
+		}
+		async_observer.flush();
+
+		EXPECT_EQ( 6u, async_observer.delivered_count() );
+		EXPECT_EQ( 3u, async_observer.failed_count() );
+	}
+
+	EXPECT_EQ( std::vector<int>({0, 2, 4}), observer.results );
+}
@@ -0,0 +1,188 @@
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "Add_Observer_Batch_Adapter.h"
+#include "Coalescing_Add_Observer.h"
+#include "Mock_Add_Observer.h"
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+class Recording_Batched_Observer : public Batched_Add_Observer_Interface
+{
+	public:
+
+		void add_occurred_batch( const Add_Event * events, size_t count ) override
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			batch_sizes.push_back( count );
+			for( size_t i = 0; i < count; ++i )
+			{
+				expressions.push_back( events[i].expression );
+				results.push_back( events[i].result );
+			}
+		}
+
+		size_t event_count()
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			return results.size();
+		}
+
+		std::mutex mutex;
+		std::vector<size_t> batch_sizes;
+		std::vector<std::string> expressions;
+		std::vector<int> results;
+};
+
+TEST(CoalescingAddObserver, DeliversFullBatches)
+{
+	Recording_Batched_Observer observer;
+	Coalescing_Add_Observer coalescer( observer, 3, 0us );
+
+	for( int i = 0; i < 7; ++i )
+	{
+		coalescer.add_occurred( std::to_string(i), i );
+	}
+
+	EXPECT_THAT( observer.batch_sizes, ElementsAre(3, 3) );
+
+	coalescer.flush();
+
+	EXPECT_THAT( observer.batch_sizes, ElementsAre(3, 3, 1) );
+	EXPECT_THAT( observer.results, ElementsAre(0, 1, 2, 3, 4, 5, 6) );
+	EXPECT_THAT( observer.expressions, ElementsAre("0", "1", "2", "3", "4", "5", "6") );
+	EXPECT_EQ( 3u, coalescer.batch_count() );
+}
+
+TEST(CoalescingAddObserver, DeliversPartialBatchAfterDelay)
+{
+	Recording_Batched_Observer observer;
+	Coalescing_Add_Observer coalescer( observer, 1000, 1000us );
+
+	coalescer.add_occurred( "1", 1 );
+	coalescer.add_occurred( "2", 2 );
+
+	const auto give_up = std::chrono::steady_clock::now() + 10s;
+	while( (observer.event_count() < 2) && (std::chrono::steady_clock::now() < give_up) )
+	{
+		std::this_thread::sleep_for( 100us );
+	}
+
+	EXPECT_THAT( observer.results, ElementsAre(1, 2) );
+}
+
+TEST(CoalescingAddObserver, DeliversRemainingEventsOnDestruction)
+{
+	Recording_Batched_Observer observer;
+	{
+		Coalescing_Add_Observer coalescer( observer, 100, 0us );
+		coalescer.add_occurred( "1", 1 );
+	}
+
+	EXPECT_THAT( observer.results, ElementsAre(1) );
+}
+
+TEST(CoalescingAddObserver, ExistingObserversWorkThroughBatchAdapter)
+{
+	Mock_Add_Observer observer;
+	Add_Observer_Batch_Adapter adapter( observer );
+	Coalescing_Add_Observer coalescer( adapter, 2, 0us );
+
+	coalescer.add_occurred( "1,2", 3 );
+	coalescer.add_occurred( "4,5", 9 );
+
+	EXPECT_EQ( 2, observer.call_count );
+	EXPECT_EQ( "4,5", observer.expression );
+	EXPECT_EQ( 9, observer.result );
+}
+
+TEST(CoalescingAddObserver, KeepsOrderAcrossThreads)
+{
+	Recording_Batched_Observer observer;
+	Coalescing_Add_Observer coalescer( observer, 16, 200us );
+
+	std::vector<std::thread> producers;
+	for( int t = 0; t < 4; ++t )
+	{
+		producers.emplace_back( [&coalescer, t]
+			{
+				for( int i = 0; i < 1000; ++i )
+				{
+					coalescer.add_occurred( "", t * 1000 + i );
+				}
+			} );
+	}
+	for( std::thread & producer : producers )
+	{
+		producer.join();
+	}
+	coalescer.flush();
+
+	ASSERT_EQ( 4000u, observer.results.size() );
+
+	// Each thread's events arrive in the order it added them.
+	std::vector<int> last_seen( 4, -1 );
+	for( int result : observer.results )
+	{
+		EXPECT_GT( result, last_seen[result / 1000] );
+		last_seen[result / 1000] = result;
+	}
+}
+
+// Throws for every batch that holds an odd result.
+class Throwing_Batched_Observer : public Recording_Batched_Observer
+{
+	public:
+
+		void add_occurred_batch( const Add_Event * events, size_t count ) override
+		{
+			Recording_Batched_Observer::add_occurred_batch( events, count );
+
+			for( size_t i = 0; i < count; ++i )
+			{
+				if( events[i].result % 2 != 0 )
+				{
+					throw std::runtime_error( "observer failed" );
+				}
+			}
+		}
+};
+
+TEST(CoalescingAddObserver, CountsAndDropsExceptionsFromTimerThread)
+{
+	Throwing_Batched_Observer observer;
+	Coalescing_Add_Observer coalescer( observer, 1000, 100us );
+
+	for( int i = 1; i <= 2; ++i )
+	{
+		coalescer.add_occurred( "", i );
+
+		const auto give_up = std::chrono::steady_clock::now() + 10s;
+		while( (coalescer.batch_count() < static_cast<size_t>(i)) && (std::chrono::steady_clock::now() < give_up) )
+		{
+			std::this_thread::sleep_for( 100us );
+		}
+	}
+
+	EXPECT_THAT( observer.results, ElementsAre(1, 2) );
+	EXPECT_EQ( 2u, coalescer.batch_count() );
+	EXPECT_EQ( 1u, coalescer.failed_count() );
+}
+
+TEST(CoalescingAddObserver, CountsAndDropsExceptionsOnDestruction)
+{
+	Throwing_Batched_Observer observer;
+	{
+		Coalescing_Add_Observer coalescer( observer, 100, 1s );
+		coalescer.add_occurred( "", 1 );
+	}
+
+	EXPECT_THAT( observer.results, ElementsAre(1) );
+}
@@ -0,0 +1,39 @@
+#ifndef COUNTING_MEMORY_RESOURCE_H
+#define COUNTING_MEMORY_RESOURCE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+
+// Passes allocations on to the default resource, counting them.
+class Counting_Memory_Resource : public std::pmr::memory_resource
+{
+	public:
+
+		Counting_Memory_Resource() :
+			allocation_count( 0 )
+		{
+		}
+
+		std::atomic<size_t> allocation_count;
+
+	private:
+
+		void * do_allocate( size_t bytes, size_t alignment ) override
+		{
+			++allocation_count;
+			return std::pmr::get_default_resource()->allocate( bytes, alignment );
+		}
+
+		void do_deallocate( void * p, size_t bytes, size_t alignment ) override
+		{
+			std::pmr::get_default_resource()->deallocate( p, bytes, alignment );
+		}
+
+		bool do_is_equal( const std::pmr::memory_resource & other ) const noexcept override
+		{
+			return this == &other;
+		}
+};
+
+#endif /*COUNTING_MEMORY_RESOURCE_H*/
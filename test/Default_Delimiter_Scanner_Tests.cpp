@@ -0,0 +1,154 @@
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "Default_Delimiter_Scanner.h"
+#include "Delimiter_Matcher.h"
+
+using Kernel = Default_Delimiter_Scanner::Kernel;
+
+class Scanned_Token_Recorder : public Token_Visitor_Interface
+{
+	public:
+
+		void token_found( std::string_view token ) override
+		{
+			tokens.emplace_back( token );
+			numbers.push_back( "?" );
+		}
+
+		void number_found( std::string_view token, int number ) override
+		{
+			tokens.emplace_back( token );
+			numbers.push_back( std::to_string(number) );
+		}
+
+		std::vector<std::string> tokens;
+		std::vector<std::string> numbers;
+};
+
+static const std::vector<Kernel> all_kernels { Kernel::scalar, Kernel::sse2, Kernel::avx2 };
+
+static std::vector<std::string> split_with_matcher( const std::string & text )
+{
+	Scanned_Token_Recorder recorder;
+	Delimiter_Matcher( {",", "\n"} ).split( text, recorder );
+	return recorder.tokens;
+}
+
+static void test_scan( const std::string & text, const std::vector<std::string> & expected_tokens, const std::vector<std::string> & expected_numbers )
+{
+	for( Kernel kernel : all_kernels )
+	{
+		Default_Delimiter_Scanner scanner( kernel );
+		Scanned_Token_Recorder recorder;
+		scanner.split( text, recorder );
+
+		EXPECT_EQ( expected_tokens, recorder.tokens );
+		EXPECT_EQ( expected_numbers, recorder.numbers );
+	}
+}
+
+TEST(DefaultDelimiterScanner, BestAvailableKernelIsSupported)
+{
+	Default_Delimiter_Scanner scanner;
+	EXPECT_NE( Kernel::best_available, scanner.kernel() );
+	EXPECT_TRUE( Default_Delimiter_Scanner::is_supported(scanner.kernel()) );
+}
+
+TEST(DefaultDelimiterScanner, ConvertsPlainNumbers)
+{
+	test_scan( "", {}, {} );
+	test_scan( "1", {"1"}, {"1"} );
+	test_scan( "1,2\n3", {"1", "2", "3"}, {"1", "2", "3"} );
+	test_scan( "0,007,12345678", {"0", "007", "12345678"}, {"0", "7", "12345678"} );
+	test_scan( "-1,2,-42", {"-1", "2", "-42"}, {"-1", "2", "-42"} );
+	test_scan( ",,\n1,,", {"1"}, {"1"} );
+}
+
+TEST(DefaultDelimiterScanner, PassesUnusualTokensThroughUnconverted)
+{
+	test_scan( "123456789", {"123456789"}, {"?"} );
+	test_scan( "-", {"-"}, {"?"} );
+	test_scan( "1-2", {"1-2"}, {"?"} );
+	test_scan( "--3", {"--3"}, {"?"} );
+	test_scan( " 4,+5,6x", {" 4", "+5", "6x"}, {"?", "?", "?"} );
+}
+
+TEST(DefaultDelimiterScanner, TokensStraddlingBlockBoundaries)
+{
+	std::string text( 62, ',' );
+	text += "12-3,45";
+	text += std::string( 60, '\n' );
+	text += "-678";
+
+	test_scan( text, {"12-3", "45", "-678"}, {"?", "45", "-678"} );
+}
+
+TEST(DefaultDelimiterScanner, AgreesWithDelimiterMatcherOnRandomText)
+{
+	const std::string alphabet( "0123456789,,,\n--x " );
+	std::mt19937 generator( 42 );
+	std::uniform_int_distribution<size_t> pick( 0, alphabet.size() - 1 );
+
+	for( size_t length : {1u, 15u, 63u, 64u, 65u, 200u, 1000u} )
+	{
+		std::string text;
+		for( size_t i = 0; i < length; ++i )
+		{
+			text += alphabet[pick(generator)];
+		}
+
+		for( Kernel kernel : all_kernels )
+		{
+			Scanned_Token_Recorder recorder;
+			Default_Delimiter_Scanner( kernel ).split( text, recorder );
+			EXPECT_EQ( split_with_matcher(text), recorder.tokens );
+
+			for( size_t i = 0; i < recorder.tokens.size(); ++i )
+			{
+				if( recorder.numbers[i] != "?" )
+				{
+					EXPECT_EQ( std::stoi(recorder.tokens[i]), std::stoi(recorder.numbers[i]) );
+				}
+			}
+		}
+	}
+}
+
+TEST(DefaultDelimiterScanner, HandsOverNumbersInRunsBetweenOtherTokens)
+{
+	class Run_Recorder : public Token_Visitor_Interface
+	{
+		public:
+
+			void token_found( std::string_view token ) override
+			{
+				calls.emplace_back( token );
+			}
+
+			void numbers_found( const std::string_view * tokens, const int * /*numbers*/, size_t count ) override
+			{
+				calls.push_back( std::to_string(count) + " from " + std::string(tokens[0]) );
+			}
+
+			std::vector<std::string> calls;
+	};
+
+	std::string text;
+	for( int i = 0; i < 100; ++i )
+	{
+		text += std::to_string( i ) + ",";
+	}
+	text += "x,7,8\n9";
+
+	for( Kernel kernel : all_kernels )
+	{
+		Run_Recorder recorder;
+		Default_Delimiter_Scanner( kernel ).split( text, recorder );
+		EXPECT_EQ( (std::vector<std::string>{ "64 from 0", "36 from 64", "x", "3 from 7" }), recorder.calls );
+	}
+}
@@ -0,0 +1,78 @@
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+
+#include "Delimiter_Header_Cache.h"
+
+using Compiled_Header = Delimiter_Header_Cache::Compiled_Header;
+
+class Counting_Compiler
+{
+	public:
+
+		Counting_Compiler() :
+			call_count( 0 )
+		{
+		}
+
+		std::shared_ptr<const Compiled_Header> operator()( std::string_view header )
+		{
+			++call_count;
+			return std::make_shared<const Compiled_Header>( Compiled_Header{ Delimiter_Matcher({std::string(header)}), false } );
+		}
+
+		int call_count;
+};
+
+TEST(DelimiterHeaderCache, CompilesOnMissAndReusesOnHit)
+{
+	Delimiter_Header_Cache cache( 4 );
+	Counting_Compiler compiler;
+	const auto compile = [&]( std::string_view header ){ return compiler( header ); };
+
+	const auto first = cache.find_or_compile( "//[***]\n", compile );
+	const auto second = cache.find_or_compile( std::string("//[***]\n"), compile );
+
+	EXPECT_EQ( first, second );
+	EXPECT_EQ( 1, compiler.call_count );
+	EXPECT_EQ( 1u, cache.hit_count() );
+	EXPECT_EQ( 1u, cache.miss_count() );
+	EXPECT_EQ( 1u, cache.size() );
+}
+
+TEST(DelimiterHeaderCache, EvictsLeastRecentlyUsedHeader)
+{
+	Delimiter_Header_Cache cache( 2 );
+	Counting_Compiler compiler;
+	const auto compile = [&]( std::string_view header ){ return compiler( header ); };
+
+	cache.find_or_compile( "//a\n", compile );
+	cache.find_or_compile( "//b\n", compile );
+	cache.find_or_compile( "//a\n", compile );
+	cache.find_or_compile( "//c\n", compile );
+	EXPECT_EQ( 2u, cache.size() );
+	EXPECT_EQ( 3, compiler.call_count );
+
+	cache.find_or_compile( "//a\n", compile );
+	EXPECT_EQ( 3, compiler.call_count );
+
+	cache.find_or_compile( "//b\n", compile );
+	EXPECT_EQ( 4, compiler.call_count );
+	EXPECT_EQ( 2u, cache.hit_count() );
+	EXPECT_EQ( 4u, cache.miss_count() );
+}
+
+TEST(DelimiterHeaderCache, ZeroCapacityCachesNothing)
+{
+	Delimiter_Header_Cache cache( 0 );
+	Counting_Compiler compiler;
+	const auto compile = [&]( std::string_view header ){ return compiler( header ); };
+
+	cache.find_or_compile( "//a\n", compile );
+	cache.find_or_compile( "//a\n", compile );
+
+	EXPECT_EQ( 2, compiler.call_count );
+	EXPECT_EQ( 0u, cache.size() );
+}
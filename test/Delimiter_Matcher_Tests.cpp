@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "Delimiter_Matcher.h"
+
+class Token_Recorder : public Token_Visitor_Interface
+{
+	public:
+
+		void token_found( std::string_view token ) override
+		{
+			tokens.emplace_back( token );
+		}
+
+		std::vector<std::string> tokens;
+};
+
+static void test_split( const std::set<std::string> & delimiters, const std::string & text, const std::vector<std::string> & expected_tokens )
+{
+	Delimiter_Matcher matcher( delimiters );
+	Token_Recorder recorder;
+	matcher.split( text, recorder );
+
+	EXPECT_EQ( expected_tokens, recorder.tokens );
+}
+
+TEST(DelimiterMatcher, MatchReturnsZeroWhenNoDelimiterStartsAtPosition)
+{
+	Delimiter_Matcher matcher( {",", "***"} );
+	EXPECT_EQ( 0u, matcher.match("1,2", 0) );
+	EXPECT_EQ( 0u, matcher.match("1**", 1) );
+}
+
+TEST(DelimiterMatcher, MatchPrefersLongestDelimiter)
+{
+	Delimiter_Matcher matcher( {",", ",*", ",**"} );
+	EXPECT_EQ( 3u, matcher.match("1,**2", 1) );
+	EXPECT_EQ( 2u, matcher.match("1,*2", 1) );
+	EXPECT_EQ( 1u, matcher.match("1,2", 1) );
+}
+
+TEST(DelimiterMatcher, MatchStopsAtEndOfText)
+{
+	Delimiter_Matcher matcher( {",", ",**"} );
+	EXPECT_EQ( 1u, matcher.match(",*", 0) );
+}
+
+TEST(DelimiterMatcher, LongestDelimiterSize)
+{
+	EXPECT_EQ( 0u, Delimiter_Matcher({}).longest_delimiter_size() );
+	EXPECT_EQ( 1u, Delimiter_Matcher({",", "\n"}).longest_delimiter_size() );
+	EXPECT_EQ( 3u, Delimiter_Matcher({",", "***", "%%"}).longest_delimiter_size() );
+}
+
+TEST(DelimiterMatcher, Split)
+{
+	test_split( {",", "\n"}, "", {} );
+	test_split( {",", "\n"}, "1,2\n3", {"1", "2", "3"} );
+	test_split( {",", "\n"}, ",,1,,", {"1"} );
+	test_split( {",", "\n", "***"}, "1***2***3", {"1", "2", "3"} );
+	test_split( {",", "\n", "*,*"}, "1*,*2*,*3", {"1", "2", "3"} );
+	test_split( {",", "\n", "**,"}, "1**,2**,3", {"1", "2", "3"} );
+}
+
+TEST(DelimiterMatcher, SplitWithManyDelimiters)
+{
+	test_split( {",", "\n", "a", "bb", "ccc", "dddd", "%", "%%", "%%%", "#", "##", "[]"},
+	            "1a2bb3ccc4dddd5%6%%7%%%8#9##10[]11",
+	            {"1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11"} );
+}
+
+TEST(DelimiterMatcher, SplitReplacesOverlappingDelimitersLongestFirst)
+{
+	test_split( {",", "\n", "xyz", "wx"}, "1wxyz2", {"1w", "2"} );
+	test_split( {",", "\n", "ab", "bcd"}, "1abcd2", {"1a", "2"} );
+	test_split( {",", "\n", "**", ";", ";*"}, "1[+;**-5]", {"1[+", "-5]"} );
+	test_split( {",", "\n", ";;;", ",x"}, "1;;;x2", {"1", "2"} );
+}
+
+TEST(DelimiterMatcher, SplitOverlappingDelimitersGivesViewsOfText)
+{
+	const std::string text( "1wxyz2wx3" );
+	Delimiter_Matcher matcher( {",", "\n", "xyz", "wx"} );
+
+	class Token_View_Recorder : public Token_Visitor_Interface
+	{
+		public:
+
+			void token_found( std::string_view token ) override
+			{
+				tokens.push_back( token );
+			}
+
+			std::vector<std::string_view> tokens;
+	} recorder;
+	matcher.split( text, recorder );
+
+	ASSERT_EQ( 3u, recorder.tokens.size() );
+	EXPECT_EQ( text.data(), recorder.tokens[0].data() );
+	EXPECT_EQ( text.data() + 5, recorder.tokens[1].data() );
+	EXPECT_EQ( text.data() + 8, recorder.tokens[2].data() );
+}
+
+// Each delimiter, longest first, replaced everywhere by a comma and the
+// result split on commas, as the calculator has always defined it.
+static std::vector<std::string> split_longest_first( std::string text, const std::set<std::string> & delimiters )
+{
+	std::vector<std::string> sorted( delimiters.begin(), delimiters.end() );
+	std::stable_sort( sorted.begin(), sorted.end(), []( const std::string & a, const std::string & b ) { return a.size() > b.size(); } );
+
+	for( const std::string & delimiter : sorted )
+	{
+		for( size_t pos = text.find( delimiter ); pos != std::string::npos; pos = text.find( delimiter, pos + 1 ) )
+		{
+			text.replace( pos, delimiter.size(), "," );
+		}
+	}
+
+	std::vector<std::string> tokens;
+	size_t start = 0;
+	while( start < text.size() )
+	{
+		const size_t end = std::min( text.find(',', start), text.size() );
+		if( end > start )
+		{
+			tokens.push_back( text.substr(start, end - start) );
+		}
+		start = end + 1;
+	}
+
+	return tokens;
+}
+
+TEST(DelimiterMatcher, AgreesWithLongestFirstReplacementOnRandomText)
+{
+	const std::string alphabet( "ab*,1" );
+	std::mt19937 generator( 1 );
+	std::uniform_int_distribution<size_t> pick( 0, alphabet.size() - 1 );
+	std::uniform_int_distribution<size_t> delimiter_size( 1, 3 );
+	std::uniform_int_distribution<size_t> delimiter_count( 0, 3 );
+
+	auto random_string = [&]( size_t size )
+	{
+		std::string s;
+		for( size_t i = 0; i < size; ++i )
+		{
+			s += alphabet[pick(generator)];
+		}
+		return s;
+	};
+
+	for( int iteration = 0; iteration < 2000; ++iteration )
+	{
+		std::set<std::string> delimiters { ",", "\n" };
+		for( size_t count = delimiter_count(generator); count > 0; --count )
+		{
+			delimiters.insert( random_string(delimiter_size(generator)) );
+		}
+
+		const std::string text( random_string(16) );
+		Token_Recorder recorder;
+		Delimiter_Matcher( delimiters ).split( text, recorder );
+
+		EXPECT_EQ( split_longest_first(text, delimiters), recorder.tokens ) << text;
+	}
+}
+
+TEST(DelimiterMatcher, IsSinglePassOnlyWhenMatchesCannotOverlap)
+{
+	EXPECT_TRUE( Delimiter_Matcher({",", "\n"}).is_single_pass() );
+	EXPECT_TRUE( Delimiter_Matcher({",", "\n", ";", "%"}).is_single_pass() );
+	EXPECT_TRUE( Delimiter_Matcher({",", "\n", "***", "%%"}).is_single_pass() );
+	EXPECT_TRUE( Delimiter_Matcher({",", "\n", "aa"}).is_single_pass() );
+	EXPECT_FALSE( Delimiter_Matcher({",", "\n", "xyz", "wx"}).is_single_pass() );
+	EXPECT_TRUE( Delimiter_Matcher({",", "\n", "*", "***"}).is_single_pass() );
+	EXPECT_FALSE( Delimiter_Matcher({",", "\n", "ab", "bcd"}).is_single_pass() );
+	EXPECT_FALSE( Delimiter_Matcher({",", "\n", ",x"}).is_single_pass() );
+}
+
+TEST(DelimiterMatcher, NeverCutsWhenMatchesCanOverlap)
+{
+	Delimiter_Matcher matcher( {",", "\n", "xyz", "wx"} );
+	EXPECT_EQ( 10u, matcher.next_safe_cut("1wxyz2,3,4", 1) );
+	EXPECT_EQ( 0u, matcher.previous_safe_cut("1wxyz2,3,4", 9) );
+}
+
+TEST(DelimiterMatcher, NextSafeCutFindsDelimiterAfterNonDelimiterByte)
+{
+	Delimiter_Matcher matcher( {",", "\n", "***"} );
+	EXPECT_EQ( 2u, matcher.next_safe_cut("12,34", 0) );
+	EXPECT_EQ( 2u, matcher.next_safe_cut("12,34", 2) );
+	EXPECT_EQ( 5u, matcher.next_safe_cut("12,34", 3) );
+	EXPECT_EQ( 1u, matcher.next_safe_cut("1***2***3", 0) );
+	EXPECT_EQ( 5u, matcher.next_safe_cut("1***2***3", 2) );
+}
+
+TEST(DelimiterMatcher, NextSafeCutNeverSplitsDelimiter)
+{
+	Delimiter_Matcher matcher( {"*", "***"} );
+	EXPECT_EQ( 1u, matcher.next_safe_cut("1*****2", 0) );
+	EXPECT_EQ( 7u, matcher.next_safe_cut("1*****2", 2) );
+	EXPECT_EQ( 3u, matcher.next_safe_cut(",,,", 0) );
+}
+
+TEST(DelimiterMatcher, PreviousSafeCutSearchesBackwards)
+{
+	Delimiter_Matcher matcher( {",", "\n", "***"} );
+	EXPECT_EQ( 0u, matcher.previous_safe_cut("", 5) );
+	EXPECT_EQ( 0u, matcher.previous_safe_cut("12,34", 1) );
+	EXPECT_EQ( 2u, matcher.previous_safe_cut("12,34", 4) );
+	EXPECT_EQ( 2u, matcher.previous_safe_cut("12,34", 100) );
+	EXPECT_EQ( 5u, matcher.previous_safe_cut("1***2***3", 7) );
+}
@@ -0,0 +1,43 @@
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "Dispatching_Tokenizer.h"
+
+static void test_dispatch( const Dispatching_Tokenizer & tokenizer, const std::string & expression, size_t expected_cache_misses )
+{
+	EXPECT_EQ( Tokenizer().parse_tokens(expression), tokenizer.parse_tokens(expression) ) << expression;
+	EXPECT_EQ( expected_cache_misses, tokenizer.generic_tokenizer().header_cache().miss_count() ) << expression;
+}
+
+TEST(DispatchingTokenizer, UsesGenericTokenizerWhenNothingIsRegistered)
+{
+	Dispatching_Tokenizer tokenizer;
+	test_dispatch( tokenizer, "1,2", 0 );
+	test_dispatch( tokenizer, "//;\n1;2", 1 );
+}
+
+TEST(DispatchingTokenizer, SendsRegisteredHeadersToSpecialisation)
+{
+	Dispatching_Tokenizer tokenizer;
+	tokenizer.register_format<';'>();
+	tokenizer.register_format<'*', '%'>();
+
+	test_dispatch( tokenizer, "//;\n1;2,3", 0 );
+	test_dispatch( tokenizer, "//[;]\n1;2\n3", 0 );
+	test_dispatch( tokenizer, "//[*][%]\n1*2%3", 0 );
+	test_dispatch( tokenizer, "//[%][*]\n1*2%3", 1 );
+	test_dispatch( tokenizer, "//[***]\n1***2", 2 );
+	test_dispatch( tokenizer, "//$\n1$2", 3 );
+}
+
+TEST(DispatchingTokenizer, CanRegisterTheDefaultFormat)
+{
+	Dispatching_Tokenizer tokenizer;
+	tokenizer.register_format<>();
+
+	test_dispatch( tokenizer, "", 0 );
+	test_dispatch( tokenizer, "1,2\n3", 0 );
+	test_dispatch( tokenizer, "//;\n1;2", 1 );
+}
@@ -0,0 +1,61 @@
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "Expression_Format.h"
+#include "Tokenizer.h"
+
+class Body_Token_Recorder : public Token_Visitor_Interface
+{
+	public:
+
+		void token_found( std::string_view token ) override
+		{
+			tokens.emplace_back( token );
+		}
+
+		std::vector<std::string> tokens;
+};
+
+static std::vector<std::string> visit_body( const std::string & body, const Expression_Format & format )
+{
+	Tokenizer tokenizer;
+	Body_Token_Recorder recorder;
+	tokenizer.visit_body_tokens( body, format, recorder );
+	return recorder.tokens;
+}
+
+TEST(ExpressionFormat, DefaultFormatSplitsOnCommaAndNewline)
+{
+	const Expression_Format format;
+	EXPECT_TRUE( format.is_default_format() );
+	EXPECT_EQ( std::vector<std::string>({"1", "2", "3"}), visit_body("1,2\n3", format) );
+}
+
+TEST(ExpressionFormat, FromDelimitersAddsTheDefaults)
+{
+	const Expression_Format format( Expression_Format::from_delimiters({"***", "%"}) );
+	EXPECT_FALSE( format.is_default_format() );
+	EXPECT_EQ( std::vector<std::string>({"1", "2", "3", "4"}), visit_body("1***2%3,4", format) );
+	EXPECT_TRUE( Expression_Format::from_delimiters({","}).is_default_format() );
+}
+
+TEST(ExpressionFormat, CompiledFromHeaderSplitsLikeTheHeader)
+{
+	Tokenizer tokenizer;
+	EXPECT_EQ( std::vector<std::string>({"1", "2"}), visit_body("1;2", tokenizer.compile_format("//;\n")) );
+	EXPECT_EQ( std::vector<std::string>({"1", "2", "3"}), visit_body("1***2%3", tokenizer.compile_format("//[***][%]\n")) );
+	EXPECT_TRUE( tokenizer.compile_format("").is_default_format() );
+	EXPECT_TRUE( tokenizer.compile_format("//,\n").is_default_format() );
+}
+
+TEST(ExpressionFormat, CompileFormatRejectsAnythingButOneHeader)
+{
+	Tokenizer tokenizer;
+	EXPECT_THROW( tokenizer.compile_format("1,2"), std::invalid_argument );
+	EXPECT_THROW( tokenizer.compile_format("//;\n1"), std::invalid_argument );
+	EXPECT_THROW( tokenizer.compile_format("//[***]"), std::invalid_argument );
+}
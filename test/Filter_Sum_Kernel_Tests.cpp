@@ -0,0 +1,78 @@
+#include <climits>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "Filter_Sum_Kernel.h"
+
+using Kernel = Filter_Sum_Kernel::Kernel;
+
+static const std::vector<Kernel> all_kernels { Kernel::scalar, Kernel::sse2, Kernel::avx2 };
+
+static void expect_filter_sum( const std::vector<int> & numbers, int64_t expected_total, bool expected_has_negative_numbers, int max_number = 1000 )
+{
+	for( Kernel kernel : all_kernels )
+	{
+		const Filter_Sum_Kernel::Result result = Filter_Sum_Kernel( kernel ).filter_sum( numbers.data(), numbers.size(), max_number );
+		EXPECT_EQ( expected_total, result.total );
+		EXPECT_EQ( expected_has_negative_numbers, result.has_negative_numbers );
+	}
+}
+
+TEST(FilterSumKernel, BestAvailableKernelIsSupported)
+{
+	const Filter_Sum_Kernel & kernel = Filter_Sum_Kernel::best_available();
+	EXPECT_NE( Kernel::best_available, kernel.kernel() );
+	EXPECT_TRUE( Filter_Sum_Kernel::is_supported(kernel.kernel()) );
+}
+
+TEST(FilterSumKernel, SumsNothing)
+{
+	expect_filter_sum( {}, 0, false );
+}
+
+TEST(FilterSumKernel, LeavesOutNumbersOverLimitAndNegatives)
+{
+	expect_filter_sum( {1, 1000, 1001, 2}, 1003, false );
+	expect_filter_sum( {0, -1, 5}, 5, true );
+	expect_filter_sum( {INT_MAX, INT_MIN, 7, 8, 9, 10, 11, 12, 13}, 70, true );
+}
+
+TEST(FilterSumKernel, NegativeLimitLeavesOutEverything)
+{
+	expect_filter_sum( {0, 1, 2, 3, 4, 5, 6, 7, 8}, 0, false, -1 );
+	expect_filter_sum( {-1, 0, INT_MAX, INT_MIN, 5, 6, 7, 8, -2}, 0, true, INT_MIN );
+}
+
+TEST(FilterSumKernel, FlagsNegativeInTail)
+{
+	expect_filter_sum( {1, 2, 3, 4, 5, 6, 7, 8, -9}, 36, true );
+}
+
+TEST(FilterSumKernel, AgreesWithScalarKernelOnRandomNumbers)
+{
+	std::mt19937 generator( 1 );
+	std::uniform_int_distribution<int> any_number( INT_MIN, INT_MAX );
+	std::uniform_int_distribution<int> small_number( -5, 1005 );
+	const Filter_Sum_Kernel scalar( Kernel::scalar );
+
+	for( size_t count = 0; count < 100; ++count )
+	{
+		std::vector<int> numbers( count );
+		for( int & number : numbers )
+		{
+			number = (count % 2 == 0) ? any_number( generator ) : small_number( generator );
+		}
+
+		const Filter_Sum_Kernel::Result expected = scalar.filter_sum( numbers.data(), numbers.size(), 1000 );
+
+		for( Kernel kernel : all_kernels )
+		{
+			const Filter_Sum_Kernel::Result result = Filter_Sum_Kernel( kernel ).filter_sum( numbers.data(), numbers.size(), 1000 );
+			EXPECT_EQ( expected.total, result.total );
+			EXPECT_EQ( expected.has_negative_numbers, result.has_negative_numbers );
+		}
+	}
+}
@@ -0,0 +1,30 @@
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "Fixed_Delimiter_Tokenizer.h"
+
+typedef Fixed_Delimiter_Tokenizer<',', '\n'> Default_Tokenizer;
+typedef Fixed_Delimiter_Tokenizer<',', '\n', ';'> Semicolon_Tokenizer;
+
+TEST(FixedDelimiterTokenizer, IsDelimiterIsKnownAtCompileTime)
+{
+	static_assert( Default_Tokenizer::is_delimiter(',') );
+	static_assert( Default_Tokenizer::is_delimiter('\n') );
+	static_assert( !Default_Tokenizer::is_delimiter(';') );
+	static_assert( Semicolon_Tokenizer::is_delimiter(';') );
+}
+
+TEST(FixedDelimiterTokenizer, SplitsOnEveryDelimiter)
+{
+	EXPECT_EQ( std::vector<std::string>(), Default_Tokenizer().parse_tokens("") );
+	EXPECT_EQ( std::vector<std::string>({"1", "2", "3"}), Default_Tokenizer().parse_tokens("1,2\n3") );
+	EXPECT_EQ( std::vector<std::string>({"1;2"}), Default_Tokenizer().parse_tokens("1;2") );
+	EXPECT_EQ( std::vector<std::string>({"1", "2", "3"}), Semicolon_Tokenizer().parse_tokens("1;2,3") );
+}
+
+TEST(FixedDelimiterTokenizer, SkipsEmptyTokens)
+{
+	EXPECT_EQ( std::vector<std::string>({"1", "2"}), Semicolon_Tokenizer().parse_tokens(",;1;;2\n") );
+}
@@ -0,0 +1,41 @@
+#include "Global_New_Counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<size_t> g_new_count( 0 );
+}
+
+
+size_t global_new_count()
+{
+	return g_new_count.load();
+}
+
+
+void * operator new( size_t size )
+{
+	++g_new_count;
+
+	if( void * p = std::malloc(size == 0 ? 1 : size) )
+	{
+		return p;
+	}
+
+	throw std::bad_alloc();
+}
+
+
+void operator delete( void * p ) noexcept
+{
+	std::free( p );
+}
+
+
+void operator delete( void * p, size_t /*size*/ ) noexcept
+{
+	std::free( p );
+}
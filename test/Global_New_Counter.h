@@ -0,0 +1,10 @@
+#ifndef GLOBAL_NEW_COUNTER_H
+#define GLOBAL_NEW_COUNTER_H
+
+#include <cstddef>
+
+// Number of calls to the global operator new, which the test program
+// replaces, since it started.
+size_t global_new_count();
+
+#endif /*GLOBAL_NEW_COUNTER_H*/
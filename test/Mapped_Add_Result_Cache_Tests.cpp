@@ -0,0 +1,175 @@
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#include "gmock/gmock.h"
+
+#include "Mapped_Add_Result_Cache.h"
+#include "Temporary_File.h"
+
+static Add_Result_Cache_Interface::Entry empty_entry()
+{
+	return Add_Result_Cache_Interface::Entry{ false, -1, std::string() };
+}
+
+static std::string read_file( const std::string & path )
+{
+	std::ifstream input( path, std::ios::binary );
+	return std::string( std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>() );
+}
+
+static void write_file( const std::string & path, const std::string & contents )
+{
+	std::ofstream output( path, std::ios::binary | std::ios::trunc );
+	output << contents;
+}
+
+TEST(MappedAddResultCache, FindsStoredEntries)
+{
+	const Temporary_File file( "" );
+	Mapped_Add_Result_Cache cache( file.path, 64 );
+	Add_Result_Cache_Interface::Entry entry = empty_entry();
+
+	EXPECT_FALSE( cache.opened_existing() );
+	EXPECT_FALSE( cache.find("1,2", entry) );
+
+	cache.store_total( "1,2", 3 );
+	cache.store_negative_numbers( "1,-2", "negatives not allowed: -2" );
+
+	ASSERT_TRUE( cache.find("1,2", entry) );
+	EXPECT_FALSE( entry.has_negative_numbers );
+	EXPECT_EQ( 3, entry.total );
+
+	ASSERT_TRUE( cache.find("1,-2", entry) );
+	EXPECT_TRUE( entry.has_negative_numbers );
+	EXPECT_EQ( "negatives not allowed: -2", entry.negative_numbers_message );
+
+	EXPECT_EQ( 2u, cache.hit_count() );
+	EXPECT_EQ( 1u, cache.miss_count() );
+}
+
+TEST(MappedAddResultCache, KeepsTotalsTooLargeForInt)
+{
+	const Temporary_File file( "" );
+	Mapped_Add_Result_Cache cache( file.path, 64 );
+	Add_Result_Cache_Interface::Entry entry = empty_entry();
+
+	cache.store_total( "1,2", 3000000000 );
+
+	ASSERT_TRUE( cache.find("1,2", entry) );
+	EXPECT_EQ( 3000000000, entry.total );
+}
+
+TEST(MappedAddResultCache, KeepsEntriesAcrossReopening)
+{
+	const Temporary_File file( "" );
+	{
+		Mapped_Add_Result_Cache cache( file.path, 64 );
+		cache.store_total( "//;\n1;2", 3 );
+	}
+
+	Mapped_Add_Result_Cache cache( file.path, 64 );
+	Add_Result_Cache_Interface::Entry entry = empty_entry();
+
+	EXPECT_TRUE( cache.opened_existing() );
+	ASSERT_TRUE( cache.find("//;\n1;2", entry) );
+	EXPECT_EQ( 3, entry.total );
+}
+
+TEST(MappedAddResultCache, StartsAfreshWithAnotherCapacity)
+{
+	const Temporary_File file( "" );
+	{
+		Mapped_Add_Result_Cache cache( file.path, 64 );
+		cache.store_total( "1", 1 );
+	}
+
+	Mapped_Add_Result_Cache cache( file.path, 128 );
+	Add_Result_Cache_Interface::Entry entry = empty_entry();
+
+	EXPECT_FALSE( cache.opened_existing() );
+	EXPECT_FALSE( cache.find("1", entry) );
+}
+
+TEST(MappedAddResultCache, StartsAfreshWhenHeaderIsCorrupt)
+{
+	const Temporary_File file( "" );
+	{
+		Mapped_Add_Result_Cache cache( file.path, 64 );
+		cache.store_total( "1", 1 );
+	}
+
+	std::string contents( read_file(file.path) );
+	contents[9] ^= 1;
+	write_file( file.path, contents );
+
+	Mapped_Add_Result_Cache cache( file.path, 64 );
+	Add_Result_Cache_Interface::Entry entry = empty_entry();
+
+	EXPECT_FALSE( cache.opened_existing() );
+	EXPECT_FALSE( cache.find("1", entry) );
+}
+
+TEST(MappedAddResultCache, IgnoresCorruptSlots)
+{
+	const Temporary_File file( "" );
+	{
+		Mapped_Add_Result_Cache cache( file.path, 64 );
+		cache.store_total( "1,2,3", 6 );
+		cache.store_total( "4,5", 9 );
+	}
+
+	// Change the total stored with "1,2,3" without fixing its checksum.
+	std::string contents( read_file(file.path) );
+	const size_t payload = contents.find( "1,2,3" );
+	ASSERT_NE( std::string::npos, payload );
+	contents[payload - 24] ^= 1;
+	write_file( file.path, contents );
+
+	Mapped_Add_Result_Cache cache( file.path, 64 );
+	Add_Result_Cache_Interface::Entry entry = empty_entry();
+
+	EXPECT_TRUE( cache.opened_existing() );
+	EXPECT_FALSE( cache.find("1,2,3", entry) );
+	EXPECT_EQ( 1u, cache.corrupt_slot_count() );
+	EXPECT_TRUE( cache.find("4,5", entry) );
+}
+
+TEST(MappedAddResultCache, SkipsExpressionsTooLongForASlot)
+{
+	const Temporary_File file( "" );
+	Mapped_Add_Result_Cache cache( file.path, 64 );
+	Add_Result_Cache_Interface::Entry entry = empty_entry();
+
+	const std::string expression( Mapped_Add_Result_Cache::slot_size, '1' );
+	cache.store_total( expression, 0 );
+
+	EXPECT_LT( cache.max_expression_size(), expression.size() );
+	EXPECT_FALSE( cache.find(expression, entry) );
+}
+
+TEST(MappedAddResultCache, EvictsWhenBucketIsFull)
+{
+	const Temporary_File file( "" );
+	Mapped_Add_Result_Cache cache( file.path, 1 );
+	Add_Result_Cache_Interface::Entry entry = empty_entry();
+
+	const size_t slots_per_bucket = Mapped_Add_Result_Cache::slots_per_bucket;
+	ASSERT_EQ( slots_per_bucket, cache.capacity() );
+
+	for( size_t i = 0; i <= cache.capacity(); ++i )
+	{
+		cache.store_total( std::to_string(i), static_cast<int>(i) );
+	}
+
+	EXPECT_FALSE( cache.find("0", entry) );
+	EXPECT_TRUE( cache.find(std::to_string(cache.capacity()), entry) );
+}
+
+TEST(MappedAddResultCache, ThrowsWhenFileIsAlreadyOpen)
+{
+	const Temporary_File file( "" );
+	Mapped_Add_Result_Cache cache( file.path, 64 );
+
+	EXPECT_THROW( Mapped_Add_Result_Cache(file.path, 64), std::system_error );
+}
@@ -0,0 +1,52 @@
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "gmock/gmock.h"
+
+#include "Mapped_File.h"
+#include "Temporary_File.h"
+
+TEST(MappedFile, ContentsAreTheFileBytes)
+{
+	const std::string contents( "//[***]\n1***2\n3" );
+	Temporary_File file( contents );
+
+	Mapped_File mapped_file( file.path );
+	EXPECT_EQ( contents, mapped_file.contents() );
+}
+
+TEST(MappedFile, EmptyFileHasEmptyContents)
+{
+	Temporary_File file( "" );
+
+	Mapped_File mapped_file( file.path );
+	EXPECT_TRUE( mapped_file.contents().empty() );
+}
+
+TEST(MappedFile, ThrowsForFilesThatAreNotRegular)
+{
+	EXPECT_THROW( Mapped_File("/dev/null"), std::system_error );
+}
+
+TEST(MappedFile, OnlyRegularFilesWithASizeAreMappable)
+{
+	Temporary_File empty_file( "" );
+	Temporary_File file( "1,2" );
+
+	for( const auto & [path, expected] : { std::make_pair(file.path, true), std::make_pair(empty_file.path, false), std::make_pair(std::string("/dev/null"), false) } )
+	{
+		const int fd = ::open( path.c_str(), O_RDONLY );
+		ASSERT_LE( 0, fd );
+		EXPECT_EQ( expected, Mapped_File::is_mappable(fd) ) << path;
+		::close( fd );
+	}
+}
+
+TEST(MappedFile, ThrowsWhenFileIsMissing)
+{
+	EXPECT_THROW( Mapped_File("/nonexistent/string-calculator-input"), std::system_error );
+}
@@ -0,0 +1,63 @@
+#include <string>
+
+#include "gmock/gmock.h"
+
+#include "Number_Parser.h"
+
+static void test_parse_number( const std::string & token, int expected_number )
+{
+	Number_Parser parser;
+	int number = 0;
+
+	EXPECT_EQ( Number_Parser::Result::number, parser.parse(token, number) ) << token;
+	EXPECT_EQ( expected_number, number ) << token;
+}
+
+static void test_parse_result( const std::string & token, Number_Parser::Result expected_result )
+{
+	Number_Parser parser;
+	int number = 0;
+
+	EXPECT_EQ( expected_result, parser.parse(token, number) ) << token;
+}
+
+TEST(NumberParser, ParsesLikeStoi)
+{
+	test_parse_number( "0", 0 );
+	test_parse_number( "1", 1 );
+	test_parse_number( "42", 42 );
+	test_parse_number( "1000", 1000 );
+	test_parse_number( "9999", 9999 );
+	test_parse_number( "-1", -1 );
+	test_parse_number( "-0", 0 );
+	test_parse_number( "+7", 7 );
+	test_parse_number( "  12", 12 );
+	test_parse_number( "0001", 1 );
+	test_parse_number( "2,1001", 2 );
+	test_parse_number( "3abc", 3 );
+	test_parse_number( "-99999", -99999 );
+	test_parse_number( "-2147483648", -2147483647 - 1 );
+}
+
+TEST(NumberParser, ClassifiesLongPositiveNumbersAsTooLargeWithoutConverting)
+{
+	test_parse_result( "10000", Number_Parser::Result::too_large );
+	test_parse_result( "99999999999", Number_Parser::Result::too_large );
+	test_parse_result( "+123456789012345678901234567890", Number_Parser::Result::too_large );
+	test_parse_result( "000012345", Number_Parser::Result::too_large );
+}
+
+TEST(NumberParser, RejectsTokensWithoutDigits)
+{
+	test_parse_result( "", Number_Parser::Result::invalid );
+	test_parse_result( "-", Number_Parser::Result::invalid );
+	test_parse_result( "abc", Number_Parser::Result::invalid );
+	test_parse_result( "- 1", Number_Parser::Result::invalid );
+	test_parse_result( "*1", Number_Parser::Result::invalid );
+}
+
+TEST(NumberParser, ReportsNegativeNumbersBeyondIntAsOutOfRange)
+{
+	test_parse_result( "-2147483649", Number_Parser::Result::out_of_range );
+	test_parse_result( "-99999999999", Number_Parser::Result::out_of_range );
+}
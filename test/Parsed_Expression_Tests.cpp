@@ -0,0 +1,161 @@
+#include <stdexcept>
+#include <string>
+
+#include "gmock/gmock.h"
+
+#include "Parsed_Expression.h"
+#include "String_Calculator.h"
+#include "Tokenizer.h"
+
+static std::string join( const Parsed_Expression & expression )
+{
+	std::string joined;
+	for( size_t i = 0; i < expression.token_count(); ++i )
+	{
+		joined += (i == 0 ? "" : ",") + expression.token( i );
+	}
+	return joined;
+}
+
+static std::string outcome_of_total( const Parsed_Expression & expression )
+{
+	try
+	{
+		return "total " + std::to_string( expression.total() );
+	}
+	catch( const std::exception & e )
+	{
+		return std::string( "error " ) + e.what();
+	}
+}
+
+static std::string outcome_of_add( const std::string & text )
+{
+	Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+
+	try
+	{
+		return "total " + std::to_string( calculator.add(text) );
+	}
+	catch( const std::exception & e )
+	{
+		return std::string( "error " ) + e.what();
+	}
+}
+
+TEST(ParsedExpression, TotalMatchesAdd)
+{
+	Tokenizer tokenizer;
+
+	for( const std::string text : { "", "1", "1,2\n3", "//[***]\n1***2***1001***1000", "1,-2,3,-4", "99999,7" } )
+	{
+		EXPECT_EQ( outcome_of_add(text), outcome_of_total(Parsed_Expression(tokenizer, text)) ) << text;
+	}
+}
+
+TEST(ParsedExpression, KeepsTokensInOrder)
+{
+	Tokenizer tokenizer;
+	const Parsed_Expression expression( tokenizer, "//;\n1;22;333" );
+
+	EXPECT_EQ( 3u, expression.token_count() );
+	EXPECT_EQ( "1,22,333", join(expression) );
+}
+
+TEST(ParsedExpression, EditsMatchAddOnTheEditedText)
+{
+	Tokenizer tokenizer;
+	Parsed_Expression expression( tokenizer, "1,2,3" );
+
+	expression.replace( 1, "20" );
+	EXPECT_EQ( "1,20,3", join(expression) );
+	EXPECT_EQ( outcome_of_add(join(expression)), outcome_of_total(expression) );
+
+	expression.insert( 0, "-5" );
+	expression.insert( 4, "1001" );
+	expression.insert( 2, "-7" );
+	EXPECT_EQ( "-5,1,-7,20,3,1001", join(expression) );
+	EXPECT_EQ( 2u, expression.negative_count() );
+	EXPECT_EQ( outcome_of_add(join(expression)), outcome_of_total(expression) );
+
+	expression.erase( 0 );
+	expression.replace( 1, "7" );
+	EXPECT_EQ( "1,7,20,3,1001", join(expression) );
+	EXPECT_EQ( 0u, expression.negative_count() );
+	EXPECT_EQ( 31, expression.total() );
+}
+
+TEST(ParsedExpression, BadTokensLeaveExpressionUnchanged)
+{
+	Tokenizer tokenizer;
+	Parsed_Expression expression( tokenizer, "1,2" );
+
+	EXPECT_THROW( expression.replace(0, "x"), std::invalid_argument );
+	EXPECT_THROW( expression.insert(1, "-99999999999"), std::out_of_range );
+	EXPECT_THROW( expression.erase(2), std::out_of_range );
+	EXPECT_THROW( expression.insert(3, "1"), std::out_of_range );
+
+	EXPECT_EQ( "1,2", join(expression) );
+	EXPECT_EQ( 3, expression.total() );
+	EXPECT_THROW( Parsed_Expression(tokenizer, "1,x"), std::invalid_argument );
+}
+
+TEST(ParsedExpression, ManyEditsKeepTheTotal)
+{
+	Tokenizer tokenizer;
+	std::string text;
+	for( int i = 0; i < 10000; ++i )
+	{
+		text += std::to_string( i % 1500 ) + ",";
+	}
+	Parsed_Expression expression( tokenizer, text );
+
+	int expected = 0;
+	for( int i = 0; i < 10000; ++i )
+	{
+		expected += ((i % 1500) <= 1000) ? (i % 1500) : 0;
+	}
+	EXPECT_EQ( expected, expression.total() );
+
+	// Turn every even token into 1 and drop every token at an index
+	// divisible by 3 in what remains.
+	for( size_t i = 0; i < 10000; i += 2 )
+	{
+		expression.replace( i, "1" );
+	}
+	for( size_t i = expression.token_count(); i-- > 0; )
+	{
+		if( i % 3 == 0 )
+		{
+			expression.erase( i );
+		}
+	}
+
+	EXPECT_EQ( outcome_of_add(join(expression)), outcome_of_total(expression) );
+}
+
+TEST(ParsedExpression, WithOverflowCheckingThrowsOnceTotalIsTooLargeForInt)
+{
+	// As many thousands as fit in an int.
+	std::string text;
+	for( int i = 0; i < 2147483; ++i )
+	{
+		text += "1000,";
+	}
+
+	Tokenizer tokenizer;
+	Parsed_Expression expression( tokenizer, text );
+	expression.set_overflow_checking( true );
+	EXPECT_EQ( 2147483000, expression.total() );
+
+	expression.insert( 0, "1000" );
+	EXPECT_THROW( expression.total(), std::overflow_error );
+
+	expression.set_overflow_checking( false );
+	EXPECT_EQ( outcome_of_add("1000," + text), outcome_of_total(expression) );
+
+	expression.set_overflow_checking( true );
+	expression.erase( 0 );
+	EXPECT_EQ( 2147483000, expression.total() );
+}
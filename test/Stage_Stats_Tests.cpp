@@ -0,0 +1,87 @@
+#include <string>
+#include <thread>
+
+#include "gmock/gmock.h"
+
+#include "Stage_Stats.h"
+#include "String_Calculator.h"
+#include "Tokenizer.h"
+#include "Mock_Add_Observer.h"
+
+TEST(StageStats, EnabledOnlyWhenCompiledIn)
+{
+#ifdef STRING_CALCULATOR_STATS
+	EXPECT_TRUE( Stage_Stats::enabled );
+#else
+	EXPECT_FALSE( Stage_Stats::enabled );
+	EXPECT_EQ( 0u, Stage_Stats::snapshot()[Add_Stage::tokenize].calls );
+#endif
+}
+
+TEST(StageStats, ResetZeroesEveryStage)
+{
+	if( !Stage_Stats::enabled )
+	{
+		GTEST_SKIP();
+	}
+
+	Stage_Stats::record( Add_Stage::notify, 1, 2, 3 );
+	Stage_Stats::reset();
+
+	const Stage_Stats::Snapshot snapshot = Stage_Stats::snapshot();
+	for( const Stage_Counters & counters : snapshot.stages )
+	{
+		EXPECT_EQ( 0u, counters.calls );
+		EXPECT_EQ( 0u, counters.nanoseconds );
+		EXPECT_EQ( 0u, counters.bytes );
+		EXPECT_EQ( 0u, counters.tokens );
+	}
+}
+
+TEST(StageStats, AddRecordsEachStage)
+{
+	if( !Stage_Stats::enabled )
+	{
+		GTEST_SKIP();
+	}
+
+	Tokenizer tokenizer;
+	Mock_Add_Observer observer;
+	String_Calculator calculator( tokenizer, observer );
+
+	Stage_Stats::reset();
+	calculator.add( "//;\n1;2;3" );
+	calculator.add( "4,5" );
+
+	const Stage_Stats::Snapshot snapshot = Stage_Stats::snapshot();
+
+	EXPECT_EQ( 2u, snapshot[Add_Stage::header].calls );
+	EXPECT_EQ( 4u, snapshot[Add_Stage::header].bytes );
+
+	EXPECT_EQ( 2u, snapshot[Add_Stage::tokenize].calls );
+	EXPECT_EQ( 12u, snapshot[Add_Stage::tokenize].bytes );
+	EXPECT_EQ( 5u, snapshot[Add_Stage::tokenize].tokens );
+
+	EXPECT_EQ( 2u, snapshot[Add_Stage::negative_check].calls );
+	EXPECT_EQ( 2u, snapshot[Add_Stage::notify].calls );
+}
+
+TEST(StageStats, SnapshotIncludesThreadsThatHaveExited)
+{
+	if( !Stage_Stats::enabled )
+	{
+		GTEST_SKIP();
+	}
+
+	Stage_Stats::reset();
+
+	std::thread thread( []{ Stage_Stats::record( Add_Stage::tokenize, 10, 20, 30 ); } );
+	thread.join();
+	Stage_Stats::record( Add_Stage::tokenize, 1, 2, 3 );
+
+	const Stage_Counters & counters = Stage_Stats::snapshot()[Add_Stage::tokenize];
+	EXPECT_EQ( 2u, counters.calls );
+	EXPECT_EQ( 11u, counters.nanoseconds );
+	EXPECT_EQ( 22u, counters.bytes );
+	EXPECT_EQ( 33u, counters.tokens );
+}
@@ -0,0 +1,60 @@
+#include <stdexcept>
+#include <string>
+
+#include "gmock/gmock.h"
+
+#include "Fixed_Delimiter_Tokenizer.h"
+#include "Mock_Add_Observer.h"
+#include "Static_String_Calculator.h"
+#include "Tokenizer.h"
+
+typedef Fixed_Delimiter_Tokenizer<',', '\n'> Default_Tokenizer;
+
+TEST(StaticStringCalculator, AddsWithFixedDelimiterTokenizer)
+{
+	Default_Tokenizer tokenizer;
+	Static_String_Calculator<Default_Tokenizer> calculator( tokenizer );
+
+	EXPECT_EQ( 0, calculator.add("") );
+	EXPECT_EQ( 6, calculator.add("1,2\n3") );
+	EXPECT_EQ( 2, calculator.add("2,1001") );
+	EXPECT_EQ( 3, calculator.get_called_count() );
+}
+
+TEST(StaticStringCalculator, AddsWithGenericTokenizer)
+{
+	Tokenizer tokenizer;
+	Static_String_Calculator<Tokenizer> calculator( tokenizer );
+
+	EXPECT_EQ( 6, calculator.add("//[***]\n1***2***3") );
+	EXPECT_EQ( 3, calculator.add("//;\n1;2") );
+}
+
+TEST(StaticStringCalculator, ThrowsForNegatives)
+{
+	Default_Tokenizer tokenizer;
+	Static_String_Calculator<Default_Tokenizer> calculator( tokenizer );
+
+	try
+	{
+		calculator.add( "1,-2,-4" );
+		FAIL() << "Expected exception";
+	}
+	catch( const std::invalid_argument & e )
+	{
+		EXPECT_STREQ( "negatives not allowed: -2 -4", e.what() );
+	}
+}
+
+TEST(StaticStringCalculator, NotifiesObserver)
+{
+	Default_Tokenizer tokenizer;
+	Mock_Add_Observer observer;
+	Static_String_Calculator<Default_Tokenizer, Mock_Add_Observer> calculator( tokenizer, observer );
+
+	calculator.add( "4,5" );
+
+	EXPECT_EQ( 1, observer.call_count );
+	EXPECT_EQ( "4,5", observer.expression );
+	EXPECT_EQ( 9, observer.result );
+}
@@ -1,3 +1,5 @@
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include "gmock/gmock.h"
 
@@ -6,6 +8,9 @@
 #include "Tokenizer_Interface.h"
 #include "Mock_Tokenizer.h"
 #include "Mock_Add_Observer.h"
+#include "Work_Stealing_Executor.h"
+#include "Expression_Format.h"
+#include "Add_Result_Cache.h"
 
 using namespace testing;
 
@@ -284,3 +289,243 @@ TEST(Add, IgnoresNumbersOverOneThousand)
 	EXPECT_EQ( 1000, add_tokens({"1000"}) );
 }
 
+
+TEST(AddBatch, EvaluatesEachExpression)
+{
+	Mock_Tokenizer tokenizer;
+	EXPECT_CALL( tokenizer, parse_tokens(_) )
+		.WillOnce(Return( std::vector<std::string>{"1", "2"} ))
+		.WillOnce(Return( std::vector<std::string>{} ))
+		.WillOnce(Return( std::vector<std::string>{"10", "1001", "20"} ));
+
+	String_Calculator calculator( tokenizer );
+
+	const std::string expressions[] = { "1,2", "", "10,1001,20" };
+	int results[3] = { -1, -1, -1 };
+	std::string error_messages[3] = { "stale", "stale", "stale" };
+
+	calculator.add_batch( expressions, 3, results, error_messages );
+
+	EXPECT_THAT( results, ElementsAre(3, 0, 30) );
+	EXPECT_THAT( error_messages, Each(IsEmpty()) );
+}
+
+TEST(AddBatch, ReportsErrorsPerItemWithoutThrowing)
+{
+	Mock_Tokenizer tokenizer;
+	EXPECT_CALL( tokenizer, parse_tokens(_) )
+		.WillOnce(Return( std::vector<std::string>{"1", "-2", "-4"} ))
+		.WillOnce(Return( std::vector<std::string>{"5"} ))
+		.WillOnce(Return( std::vector<std::string>{"x"} ));
+
+	String_Calculator calculator( tokenizer );
+
+	const std::string expressions[] = { "1,-2,-4", "5", "x" };
+	int results[3];
+	std::string error_messages[3];
+
+	calculator.add_batch( expressions, 3, results, error_messages );
+
+	EXPECT_THAT( results, ElementsAre(0, 5, 0) );
+	EXPECT_EQ( "negatives not allowed: -2 -4", error_messages[0] );
+	EXPECT_EQ( "", error_messages[1] );
+	EXPECT_FALSE( error_messages[2].empty() );
+}
+
+TEST(AddBatch, CountsEveryItemAsAnAddCall)
+{
+	Mock_Tokenizer tokenizer;
+	String_Calculator calculator( tokenizer );
+
+	const std::string expressions[] = { "", "", "" };
+	int results[3];
+	std::string error_messages[3];
+
+	calculator.add( "" );
+	calculator.add_batch( expressions, 3, results, error_messages );
+
+	EXPECT_EQ( 4, calculator.get_called_count() );
+}
+
+TEST(AddBatch, NotifiesObserverForEachSuccessfulItem)
+{
+	Mock_Tokenizer tokenizer;
+	EXPECT_CALL( tokenizer, parse_tokens(_) )
+		.WillOnce(Return( std::vector<std::string>{"1"} ))
+		.WillOnce(Return( std::vector<std::string>{"-1"} ))
+		.WillOnce(Return( std::vector<std::string>{"7"} ));
+
+	Mock_Add_Observer observer;
+	String_Calculator calculator( tokenizer, observer );
+
+	const std::string expressions[] = { "1", "-1", "7" };
+	int results[3];
+	std::string error_messages[3];
+
+	calculator.add_batch( expressions, 3, results, error_messages );
+
+	EXPECT_EQ( 2, observer.call_count );
+	EXPECT_EQ( "7", observer.expression );
+	EXPECT_EQ( 7, observer.result );
+}
+
+TEST(AddBatch, ParallelOverloadMatchesSerialOverload)
+{
+	Mock_Tokenizer tokenizer;
+	ON_CALL( tokenizer, parse_tokens("1,2") ).WillByDefault(Return( std::vector<std::string>{"1", "2"} ));
+	ON_CALL( tokenizer, parse_tokens("-3") ).WillByDefault(Return( std::vector<std::string>{"-3"} ));
+	ON_CALL( tokenizer, parse_tokens("x") ).WillByDefault(Return( std::vector<std::string>{"x"} ));
+	EXPECT_CALL( tokenizer, parse_tokens(_) ).Times(AnyNumber());
+
+	Mock_Add_Observer observer;
+	String_Calculator calculator( tokenizer, observer );
+	Work_Stealing_Executor executor( 4 );
+
+	const std::string expressions[] = { "1,2", "-3", "x", "1,2" };
+	int results[4];
+	std::string error_messages[4];
+
+	calculator.add_batch( expressions, 4, results, error_messages, executor );
+
+	EXPECT_THAT( results, ElementsAre(3, 0, 0, 3) );
+	EXPECT_EQ( "", error_messages[0] );
+	EXPECT_EQ( "negatives not allowed: -3", error_messages[1] );
+	EXPECT_FALSE( error_messages[2].empty() );
+	EXPECT_EQ( "", error_messages[3] );
+	EXPECT_EQ( 2, observer.call_count );
+	EXPECT_EQ( 4, calculator.get_called_count() );
+}
+
+TEST(AddWithExecutor, SumsWholeExpressionWhenTokenizerCannotCut)
+{
+	Mock_Tokenizer tokenizer;
+	EXPECT_CALL( tokenizer, parse_tokens("1,2,-3") )
+		.WillOnce(Return( std::vector<std::string>{"1", "2"} ))
+		.WillOnce(Return( std::vector<std::string>{"1", "-3"} ));
+
+	Mock_Add_Observer observer;
+	String_Calculator calculator( tokenizer, observer );
+	Work_Stealing_Executor executor( 4 );
+
+	EXPECT_EQ( 3, calculator.add("1,2,-3", executor) );
+	EXPECT_EQ( 1, observer.call_count );
+	EXPECT_THROW( calculator.add("1,2,-3", executor), std::invalid_argument );
+	EXPECT_EQ( 2, calculator.get_called_count() );
+}
+
+TEST(AddFromStream, SumsTokensOfWholeStream)
+{
+	Mock_Tokenizer tokenizer;
+	EXPECT_CALL( tokenizer, parse_tokens("1,2") )
+		.WillOnce(Return( std::vector<std::string>{"1", "2"} ));
+
+	Mock_Add_Observer observer;
+	String_Calculator calculator( tokenizer, observer );
+
+	std::istringstream input( "1,2" );
+	EXPECT_EQ( 3, calculator.add(input) );
+	EXPECT_EQ( 1, observer.call_count );
+	EXPECT_EQ( 3, observer.result );
+	EXPECT_EQ( 1, calculator.get_called_count() );
+}
+
+TEST(AddWithFormat, SplitsBodyWithFormatMatcherByDefault)
+{
+	Mock_Tokenizer tokenizer;
+	EXPECT_CALL( tokenizer, parse_tokens(_) ).Times(0);
+
+	Mock_Add_Observer observer;
+	String_Calculator calculator( tokenizer, observer );
+
+	EXPECT_EQ( 6, calculator.add("1;2,3", Expression_Format::from_delimiters({";"})) );
+	EXPECT_EQ( "1;2,3", observer.expression );
+	EXPECT_EQ( 1, calculator.get_called_count() );
+}
+
+TEST(Add, WithResultCacheTokenizesRepeatedExpressionOnce)
+{
+	Mock_Tokenizer tokenizer;
+	EXPECT_CALL( tokenizer, parse_tokens("1,2") )
+		.Times(1)
+		.WillOnce(Return(std::vector<std::string>{ "1", "2" }));
+
+	Add_Result_Cache cache( 8 );
+	String_Calculator calculator( tokenizer );
+	calculator.set_result_cache( &cache );
+
+	EXPECT_EQ( 3, calculator.add("1,2") );
+	EXPECT_EQ( 3, calculator.add("1,2") );
+}
+
+TEST(Add, WithResultCacheBypassesItForExpressionsOverMaxSize)
+{
+	Mock_Tokenizer tokenizer;
+	EXPECT_CALL( tokenizer, parse_tokens("1,22") )
+		.Times(2)
+		.WillRepeatedly(Return(std::vector<std::string>{ "1", "22" }));
+
+	Add_Result_Cache cache( 8, Add_Result_Cache::default_slots_per_shard, 3 );
+	String_Calculator calculator( tokenizer );
+	calculator.set_result_cache( &cache );
+
+	EXPECT_EQ( 23, calculator.add("1,22") );
+	EXPECT_EQ( 23, calculator.add("1,22") );
+	EXPECT_EQ( 0u, cache.miss_count() );
+}
+
+TEST(Add, WithOverflowCheckingThrowsForTotalTooLargeForInt)
+{
+	// Just enough thousands to go past INT_MAX.
+	const std::vector<std::string> overflowing_tokens( 2147484, "1000" );
+
+	Mock_Tokenizer tokenizer;
+	EXPECT_CALL( tokenizer, parse_tokens(_) )
+		.WillRepeatedly(Return( overflowing_tokens ));
+
+	String_Calculator calculator( tokenizer );
+	calculator.set_overflow_checking( true );
+
+	EXPECT_THROW( calculator.add(arbitrary_str), std::overflow_error );
+	EXPECT_EQ( Add_Error::Kind::total_out_of_range, calculator.try_add(arbitrary_str).error().kind() );
+
+	int result = -1;
+	std::string error_message;
+	calculator.add_batch( &arbitrary_str, 1, &result, &error_message );
+	EXPECT_EQ( 0, result );
+	EXPECT_EQ( "total out of range", error_message );
+}
+
+TEST(Add, WithOverflowCheckingReturnsTotalThatFitsInInt)
+{
+	Mock_Tokenizer tokenizer;
+	EXPECT_CALL( tokenizer, parse_tokens(_) )
+		.WillOnce(Return(std::vector<std::string>{ "1000", "1001", "2" }));
+
+	String_Calculator calculator( tokenizer );
+	calculator.set_overflow_checking( true );
+
+	EXPECT_EQ( 1002, calculator.add(arbitrary_str) );
+}
+
+TEST(Add, WithResultCacheAppliesOverflowCheckingToCachedTotals)
+{
+	const std::vector<std::string> overflowing_tokens( 2147484, "1000" );
+
+	Mock_Tokenizer tokenizer;
+	EXPECT_CALL( tokenizer, parse_tokens(_) )
+		.Times(1)
+		.WillOnce(Return( overflowing_tokens ));
+
+	Add_Result_Cache cache( 8 );
+	String_Calculator calculator( tokenizer );
+	calculator.set_result_cache( &cache );
+
+	const int wrapped_total = calculator.add( arbitrary_str );
+
+	calculator.set_overflow_checking( true );
+	EXPECT_THROW( calculator.add(arbitrary_str), std::overflow_error );
+
+	calculator.set_overflow_checking( false );
+	EXPECT_EQ( wrapped_total, calculator.add(arbitrary_str) );
+	EXPECT_EQ( 2u, cache.hit_count() );
+}
@@ -0,0 +1,178 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "Sum_Accumulator.h"
+#include "Counting_Memory_Resource.h"
+
+static int accumulate( const std::vector<std::string> & tokens )
+{
+	Sum_Accumulator accumulator;
+
+	for( const std::string & token : tokens )
+	{
+		accumulator.token_found( token );
+	}
+
+	accumulator.throw_if_has_negative_number();
+	return accumulator.total();
+}
+
+TEST(SumAccumulator, TotalIsZeroWithoutTokens)
+{
+	Sum_Accumulator accumulator;
+	EXPECT_EQ( 0, accumulator.total() );
+	EXPECT_FALSE( accumulator.has_negative_numbers() );
+}
+
+TEST(SumAccumulator, SumsTokens)
+{
+	EXPECT_EQ( 1, accumulate({"1"}) );
+	EXPECT_EQ( 48, accumulate({"1", "2", "3", "42"}) );
+}
+
+TEST(SumAccumulator, SkipsNumbersOverOneThousand)
+{
+	EXPECT_EQ( 0, accumulate({"1001"}) );
+	EXPECT_EQ( 2, accumulate({"2", "1001"}) );
+	EXPECT_EQ( 1000, accumulate({"1000"}) );
+}
+
+TEST(SumAccumulator, RemembersNegativesInOrder)
+{
+	Sum_Accumulator accumulator;
+	accumulator.add_number( 1 );
+	accumulator.add_number( -2 );
+	accumulator.add_number( -4 );
+	accumulator.add_number( 8 );
+
+	EXPECT_TRUE( accumulator.has_negative_numbers() );
+	EXPECT_EQ( "negatives not allowed: -2 -4", accumulator.negative_numbers_message() );
+	EXPECT_THROW( accumulator.throw_if_has_negative_number(), std::invalid_argument );
+}
+
+TEST(SumAccumulator, ResetForgetsEverything)
+{
+	Sum_Accumulator accumulator;
+	accumulator.add_number( 5 );
+	accumulator.add_number( -1 );
+	accumulator.reset();
+
+	EXPECT_EQ( 0, accumulator.total() );
+	EXPECT_FALSE( accumulator.has_negative_numbers() );
+}
+
+TEST(SumAccumulator, MergeAppendsOtherTotalAndNegatives)
+{
+	Sum_Accumulator first;
+	first.add_number( 1 );
+	first.add_number( -2 );
+
+	Sum_Accumulator second;
+	second.add_number( -4 );
+	second.add_number( 8 );
+
+	first.merge( second );
+
+	EXPECT_EQ( 9, first.total() );
+	EXPECT_EQ( "negatives not allowed: -2 -4", first.negative_numbers_message() );
+}
+
+TEST(SumAccumulator, RemembersNegativesInGivenResource)
+{
+	Counting_Memory_Resource resource;
+	Sum_Accumulator accumulator( &resource );
+	accumulator.add_number( 1 );
+	EXPECT_EQ( 0u, resource.allocation_count );
+
+	accumulator.add_number( -2 );
+	EXPECT_LT( 0u, resource.allocation_count );
+	EXPECT_EQ( "negatives not allowed: -2", accumulator.negative_numbers_message() );
+}
+
+TEST(SumAccumulator, RemembersWhereNegativeTokensStart)
+{
+	const std::string text( "1,-2,-30" );
+	Sum_Accumulator accumulator;
+	accumulator.token_found( std::string_view(text).substr(2, 2) );
+	accumulator.number_found( std::string_view(text).substr(5, 3), -30 );
+	accumulator.add_number( -4 );
+
+	ASSERT_EQ( 3u, accumulator.negative_number_count() );
+	EXPECT_EQ( -2, accumulator.negative_number(0) );
+	EXPECT_EQ( text.data() + 2, accumulator.negative_token(0) );
+	EXPECT_EQ( -30, accumulator.negative_number(1) );
+	EXPECT_EQ( text.data() + 5, accumulator.negative_token(1) );
+	EXPECT_EQ( nullptr, accumulator.negative_token(2) );
+}
+
+TEST(SumAccumulator, NumbersFoundRemembersWhereNegativeTokensStart)
+{
+	const std::string text( "1,-2,1001,-30" );
+	const std::string_view view( text );
+	const std::string_view tokens[] = { view.substr(0, 1), view.substr(2, 2), view.substr(5, 4), view.substr(10, 3) };
+	const int numbers[] = { 1, -2, 1001, -30 };
+
+	Sum_Accumulator accumulator;
+	accumulator.numbers_found( tokens, numbers, 4 );
+
+	EXPECT_EQ( 1, accumulator.total() );
+	ASSERT_EQ( 2u, accumulator.negative_number_count() );
+	EXPECT_EQ( text.data() + 2, accumulator.negative_token(0) );
+	EXPECT_EQ( text.data() + 10, accumulator.negative_token(1) );
+	EXPECT_EQ( "negatives not allowed: -2 -30", accumulator.negative_numbers_message() );
+}
+
+TEST(SumAccumulator, AddNumbersAppliesSameRulesAsAddNumber)
+{
+	std::vector<int> numbers;
+	Sum_Accumulator one_at_a_time;
+	std::vector<int> expected_negatives;
+	int expected_total = 0;
+
+	for( int i = 0; i < 1000; ++i )
+	{
+		const int number = (i % 7 == 0) ? -i - 1 : (i % 5 == 0) ? 1000 + i : i;
+		numbers.push_back( number );
+		one_at_a_time.add_number( number );
+
+		if( number < 0 )
+		{
+			expected_negatives.push_back( number );
+		}
+		else if( number <= 1000 )
+		{
+			expected_total += number;
+		}
+	}
+
+	Sum_Accumulator accumulator;
+	accumulator.add_number( 1 );
+	accumulator.add_numbers( numbers.data(), numbers.size() );
+
+	EXPECT_EQ( 1 + expected_total, accumulator.total() );
+	EXPECT_EQ( expected_total, one_at_a_time.total() );
+	ASSERT_EQ( expected_negatives.size(), accumulator.negative_number_count() );
+	for( size_t i = 0; i < expected_negatives.size(); ++i )
+	{
+		EXPECT_EQ( expected_negatives[i], accumulator.negative_number(i) );
+		EXPECT_EQ( nullptr, accumulator.negative_token(i) );
+	}
+	EXPECT_EQ( one_at_a_time.negative_numbers_message(), accumulator.negative_numbers_message() );
+}
+
+TEST(SumAccumulator, WideTotalDoesNotWrap)
+{
+	const int64_t count = 3000000;
+	Sum_Accumulator accumulator;
+
+	for( int64_t i = 0; i < count; ++i )
+	{
+		accumulator.add_number( 1000 );
+	}
+
+	EXPECT_EQ( count * 1000, accumulator.wide_total() );
+	EXPECT_FALSE( accumulator.total_fits_in_int() );
+}
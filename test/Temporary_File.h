@@ -0,0 +1,32 @@
+#ifndef TEMPORARY_FILE_H
+#define TEMPORARY_FILE_H
+
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+
+#include <unistd.h>
+
+// A file holding the given contents, removed again on destruction.
+class Temporary_File
+{
+	public:
+
+		Temporary_File( const std::string & contents ) :
+			path( "/tmp/string-calculator-XXXXXX" )
+		{
+			const int fd = mkstemp( &path[0] );
+			FILE * p_file = fdopen( fd, "wb" );
+			std::fwrite( contents.data(), 1, contents.size(), p_file );
+			std::fclose( p_file );
+		}
+
+		~Temporary_File()
+		{
+			std::remove( path.c_str() );
+		}
+
+		std::string path;
+};
+
+#endif /*TEMPORARY_FILE_H*/
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -5,6 +6,7 @@
 
 #include "Tokenizer.h"
 #include "Tokenizer_Interface.h"
+#include "Counting_Memory_Resource.h"
 
 TEST(TokenizerDefaultConstructor, CanDefaultConstruct)
 {
@@ -92,3 +94,223 @@ TEST(Tokenizer, ParseTokensMultipleDynamicDelimiterDeclaration)
 	test_parse_tokens( "//[AZ,]\n1AZ,2AZ,3", {"1", "2", "3"} );
 }
 
+TEST(Tokenizer, ParseTokensReplacesOverlappingDelimitersLongestFirst)
+{
+	test_parse_tokens( "//[xyz][wx]\n1wxyz2", {"1w", "2"} );
+	test_parse_tokens( "//[ab][bcd]\n1abcd2", {"1a", "2"} );
+	test_parse_tokens( "//[**][;][;*]\n1[+;**-5]", {"1[+", "-5]"} );
+}
+
+
+class Token_View_Recorder : public Token_Visitor_Interface
+{
+	public:
+
+		void token_found( std::string_view token ) override
+		{
+			tokens.push_back( token );
+		}
+
+		std::vector<std::string_view> tokens;
+};
+
+static void test_visit_tokens( const std::string & expression, const std::vector<std::string> & expected_tokens )
+{
+	Tokenizer tokenizer;
+	Token_View_Recorder recorder;
+	tokenizer.visit_tokens( expression, recorder );
+
+	EXPECT_EQ( expected_tokens, std::vector<std::string>(recorder.tokens.begin(), recorder.tokens.end()) );
+}
+
+TEST(TokenizerVisitTokens, VisitsSameTokensAsParseTokens)
+{
+	test_visit_tokens( "", {} );
+	test_visit_tokens( "1", {"1"} );
+	test_visit_tokens( "1\n2,3", {"1", "2", "3"} );
+	test_visit_tokens( "//;\n1;2", {"1", "2"} );
+	test_visit_tokens( "//[***]\n1***2***3", {"1", "2", "3"} );
+	test_visit_tokens( "//[*][%]\n1*2%3", {"1", "2", "3"} );
+	test_visit_tokens( "//[,**]\n1,**2,**3", {"1", "2", "3"} );
+	test_visit_tokens( "1,,2", {"1", "2"} );
+	test_visit_tokens( "//[xyz][wx]\n1wxyz2", {"1w", "2"} );
+	test_visit_tokens( "//[ab][bcd]\n1abcd2", {"1a", "2"} );
+}
+
+TEST(TokenizerVisitTokens, TokensAreViewsIntoCallersBuffer)
+{
+	const std::string expression( "//[***]\n10***20,30" );
+
+	Tokenizer tokenizer;
+	Token_View_Recorder recorder;
+	tokenizer.visit_tokens( expression, recorder );
+
+	ASSERT_EQ( 3u, recorder.tokens.size() );
+	EXPECT_EQ( expression.data() + 8, recorder.tokens[0].data() );
+	EXPECT_EQ( expression.data() + 13, recorder.tokens[1].data() );
+	EXPECT_EQ( expression.data() + 16, recorder.tokens[2].data() );
+}
+
+static std::vector<std::string> visit_chunks( const std::string & expression, size_t max_chunks, size_t & chunk_count )
+{
+	Tokenizer tokenizer;
+	const auto p_chunks = tokenizer.cut_into_chunks( expression, max_chunks );
+	chunk_count = p_chunks->chunk_count();
+
+	Token_View_Recorder recorder;
+	for( size_t chunk = 0; chunk < chunk_count; ++chunk )
+	{
+		p_chunks->visit_chunk_tokens( chunk, recorder );
+	}
+
+	return std::vector<std::string>( recorder.tokens.begin(), recorder.tokens.end() );
+}
+
+static void test_cut_into_chunks( const std::string & expression, size_t max_chunks )
+{
+	size_t chunk_count = 0;
+	EXPECT_EQ( Tokenizer().parse_tokens(expression), visit_chunks(expression, max_chunks, chunk_count) ) << expression;
+	EXPECT_LE( chunk_count, std::max<size_t>(max_chunks, 1) );
+}
+
+TEST(TokenizerCutIntoChunks, KeepsSmallExpressionsWhole)
+{
+	size_t chunk_count = 0;
+	EXPECT_EQ( empty_vector, visit_chunks("", 8, chunk_count) );
+	EXPECT_EQ( 1u, chunk_count );
+	EXPECT_EQ( std::vector<std::string>({"1", "2"}), visit_chunks("1,2", 1, chunk_count) );
+	EXPECT_EQ( 1u, chunk_count );
+}
+
+TEST(TokenizerCutIntoChunks, ChunksVisitSameTokensAsWholeExpression)
+{
+	for( size_t max_chunks = 1; max_chunks <= 12; ++max_chunks )
+	{
+		test_cut_into_chunks( "1\n2,3,,45,678,9", max_chunks );
+		test_cut_into_chunks( "//;\n1;2;;3;45;6", max_chunks );
+		test_cut_into_chunks( "//[***]\n1***2******3***45***6", max_chunks );
+		test_cut_into_chunks( "//[*][**][***]\n1*2**3***4****5*****6", max_chunks );
+		test_cut_into_chunks( "//[,**]\n1,**2,3,**4,,**5", max_chunks );
+		test_cut_into_chunks( "//[*\n*]\n1*\n*2\n3*\n*4", max_chunks );
+	}
+}
+
+TEST(TokenizerCutIntoChunks, CutsLargeExpressionsIntoRequestedChunks)
+{
+	std::string expression( "//[***]\n" );
+	for( int i = 0; i < 1000; ++i )
+	{
+		expression += std::to_string( i ) + "***";
+	}
+
+	size_t chunk_count = 0;
+	const std::vector<std::string> tokens = visit_chunks( expression, 8, chunk_count );
+
+	EXPECT_EQ( 8u, chunk_count );
+	EXPECT_EQ( Tokenizer().parse_tokens(expression), tokens );
+}
+
+class Trickling_Byte_Source : public Byte_Source_Interface
+{
+	public:
+
+		Trickling_Byte_Source( const std::string & text, size_t bytes_per_read ) :
+			m_text( text ),
+			m_bytes_per_read( bytes_per_read ),
+			m_pos( 0 )
+		{
+		}
+
+		size_t read( char * buffer, size_t size ) override
+		{
+			const size_t count = m_text.copy( buffer, std::min(size, m_bytes_per_read), m_pos );
+			m_pos += count;
+			return count;
+		}
+
+	private:
+
+		const std::string m_text;
+		const size_t m_bytes_per_read;
+		size_t m_pos;
+};
+
+// Streamed tokens point into the tokenizer's buffer, so keep copies.
+class Token_Copy_Recorder : public Token_Visitor_Interface
+{
+	public:
+
+		void token_found( std::string_view token ) override
+		{
+			tokens.emplace_back( token );
+		}
+
+		std::vector<std::string> tokens;
+};
+
+static void test_visit_source_tokens( const std::string & expression )
+{
+	for( size_t bytes_per_read = 1; bytes_per_read <= 8; ++bytes_per_read )
+	{
+		Tokenizer tokenizer;
+		Trickling_Byte_Source source( expression, bytes_per_read );
+		Token_Copy_Recorder recorder;
+		tokenizer.visit_source_tokens( source, recorder );
+
+		EXPECT_EQ( tokenizer.parse_tokens(expression), recorder.tokens ) << expression << " read " << bytes_per_read << " bytes at a time";
+	}
+}
+
+TEST(TokenizerVisitSourceTokens, VisitsSameTokensAsParseTokensWhateverTheReadSize)
+{
+	test_visit_source_tokens( "" );
+	test_visit_source_tokens( "/" );
+	test_visit_source_tokens( "//" );
+	test_visit_source_tokens( "1\n22,333,,4444" );
+	test_visit_source_tokens( "//;\n1;22;;333" );
+	test_visit_source_tokens( "//[***]\n1***22******333***" );
+	test_visit_source_tokens( "//[*][**][***]\n1*2**3***4****5*****6" );
+	test_visit_source_tokens( "//[,**]\n1,**2,3,**4,,**5" );
+	test_visit_source_tokens( "//[*\n*]\n1*\n*2\n3*\n*4" );
+	test_visit_source_tokens( "//[\n1[2[3" );
+	test_visit_source_tokens( "//[]\n1,2,3" );
+	test_visit_source_tokens( "//[xyz][wx]\n1wxyz2wx3xyz4" );
+	test_visit_source_tokens( "//[**][;][;*]\n1[+;**-5]" );
+}
+
+TEST(TokenizerVisitSourceTokens, BuffersInScratchResource)
+{
+	Counting_Memory_Resource resource;
+	Tokenizer tokenizer( Tokenizer::default_header_cache_capacity, &resource );
+	Trickling_Byte_Source source( "//;\n1;22;;333", 4 );
+	Token_Copy_Recorder recorder;
+	tokenizer.visit_source_tokens( source, recorder );
+
+	EXPECT_THAT( recorder.tokens, testing::ElementsAre("1", "22", "333") );
+	EXPECT_LT( 0u, resource.allocation_count );
+}
+
+TEST(TokenizerHeaderCache, RepeatedHeadersHitTheCache)
+{
+	Tokenizer tokenizer;
+
+	EXPECT_EQ( std::vector<std::string>({"1", "2"}), tokenizer.parse_tokens("//[***][%%]\n1***2") );
+	EXPECT_EQ( std::vector<std::string>({"3", "4"}), tokenizer.parse_tokens("//[***][%%]\n3%%4") );
+	EXPECT_EQ( std::vector<std::string>({"5", "6"}), tokenizer.parse_tokens("5,6") );
+	EXPECT_EQ( std::vector<std::string>({"7", "8"}), tokenizer.parse_tokens("//;\n7;8") );
+
+	EXPECT_EQ( 1u, tokenizer.header_cache().hit_count() );
+	EXPECT_EQ( 2u, tokenizer.header_cache().miss_count() );
+}
+
+TEST(TokenizerHeaderCache, CacheIsBounded)
+{
+	Tokenizer tokenizer( 2 );
+
+	tokenizer.parse_tokens( "//a\n1" );
+	tokenizer.parse_tokens( "//b\n1" );
+	tokenizer.parse_tokens( "//c\n1" );
+
+	EXPECT_EQ( 2u, tokenizer.header_cache().capacity() );
+	EXPECT_EQ( 2u, tokenizer.header_cache().size() );
+}
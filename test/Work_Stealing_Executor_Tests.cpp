@@ -0,0 +1,72 @@
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "Work_Stealing_Executor.h"
+
+using namespace testing;
+
+static size_t unit_weight( size_t )
+{
+	return 1;
+}
+
+static std::vector<int> count_visits( Work_Stealing_Executor & executor, size_t count, const std::function<size_t(size_t)> & weight )
+{
+	std::vector<std::atomic<int>> visits( count );
+	executor.for_each( count, weight, [&]( size_t i ){ ++visits[i]; } );
+
+	return std::vector<int>( visits.begin(), visits.end() );
+}
+
+TEST(WorkStealingExecutor, HasAtLeastOneThread)
+{
+	EXPECT_EQ( 1, Work_Stealing_Executor(0).thread_count() );
+	EXPECT_EQ( 1, Work_Stealing_Executor(1).thread_count() );
+	EXPECT_EQ( 4, Work_Stealing_Executor(4).thread_count() );
+}
+
+TEST(WorkStealingExecutor, RunsNothingForEmptyBatch)
+{
+	Work_Stealing_Executor executor( 4 );
+	EXPECT_THAT( count_visits(executor, 0, unit_weight), IsEmpty() );
+}
+
+TEST(WorkStealingExecutor, RunsEveryTaskOnceOnOneThread)
+{
+	Work_Stealing_Executor executor( 1 );
+	EXPECT_THAT( count_visits(executor, 1000, unit_weight), Each(1) );
+}
+
+TEST(WorkStealingExecutor, RunsEveryTaskOnceOnManyThreads)
+{
+	Work_Stealing_Executor executor( 8 );
+	EXPECT_THAT( count_visits(executor, 3, unit_weight), Each(1) );
+	EXPECT_THAT( count_visits(executor, 100000, unit_weight), Each(1) );
+}
+
+TEST(WorkStealingExecutor, RunsEveryTaskOnceWithUnevenWeights)
+{
+	Work_Stealing_Executor executor( 4 );
+	EXPECT_THAT( count_visits(executor, 5000, []( size_t i ){ return (i % 997 == 0) ? size_t(1) << 30 : 0; }), Each(1) );
+}
+
+TEST(WorkStealingExecutor, RethrowsFirstExceptionAfterRunningEveryTask)
+{
+	Work_Stealing_Executor executor( 4 );
+	std::atomic<int> visits( 0 );
+
+	EXPECT_THROW( executor.for_each(1000, unit_weight, [&]( size_t i )
+		{
+			++visits;
+			if( i % 100 == 0 )
+			{
+				throw std::runtime_error( "task failed" );
+			}
+		}), std::runtime_error );
+
+	EXPECT_EQ( 1000, visits );
+	EXPECT_THAT( count_visits(executor, 10, unit_weight), Each(1) );
+}